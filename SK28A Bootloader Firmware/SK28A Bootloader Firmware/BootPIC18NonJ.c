@@ -1,624 +1,1484 @@
-/*********************************************************************
- *
- *   Microchip USB HID Bootloader for PIC18F and PIC18LF versions of:
- *	 PIC18F4553/4458/2553/2458
- *	 PIC18F4550/4455/2550/2455
- *	 PIC18F4450/2450
- *   PIC18F14K50/13K50
- *
- *********************************************************************
- * FileName:        BootPIC18NonJ.c
- * Dependencies:    See INCLUDES section below
- * Processor:       PIC18
- * Compiler:        C18 3.32+
- * Company:         Microchip Technology, Inc.
- *
- * Software License Agreement
- *
- * The software supplied herewith by Microchip Technology Incorporated
- * (the Company) for its PICmicro Microcontroller is intended and
- * supplied to you, the Companys customer, for use solely and
- * exclusively on Microchip PICmicro Microcontroller products. The
- * software is owned by the Company and/or its supplier, and is
- * protected under applicable copyright laws. All rights are reserved.
- * Any use in violation of the foregoing restrictions may subject the
- * user to criminal sanctions under applicable laws, as well as to
- * civil liability for the breach of the terms and conditions of this
- * license.
- *
- * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
- * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
- * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
- * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
- * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
- * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
- *
- * File version         Date        Comment
- *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
- * 1.0					06/19/08	Original Version.  Adapted from 
- *									MCHPFSUSB v2.1 HID Bootloader
- *									for PIC18F87J50 Family devices.
- *********************************************************************/
-
-/** C O N S T A N T S **********************************************************/
-
-//Section defining the address range to erase for the erase device command, along with the valid programming range to be reported by the QUERY_DEVICE command.
-#define ProgramMemStart					0x001000 //Beginning of application program memory (not occupied by bootloader).  **THIS VALUE MUST BE ALIGNED WITH 64 BYTE BLOCK BOUNDRY** Also, in order to work correctly, make sure the StartPageToErase is set to erase this section.
-
-#if defined(__18F4550)||defined(__18F2550)
-	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
-	#define MaxPageToErase				511		 //Last 64 byte page of flash on the PIC18F4550
-	#define ProgramMemStop				0x008000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
-	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
-	#define	UserIDSize					8
-	#define	DEVICE_WITH_EEPROM
-	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
-	#define EEPROMEffectiveAddress		0xF00000
-	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
-#elif defined(__18F4553)||defined(__18F2553)
-	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
-	#define MaxPageToErase				511		 //Last 64 byte page of flash on the PIC18F4550
-	#define ProgramMemStop				0x008000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
-	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
-	#define	UserIDSize					8
-	#define	DEVICE_WITH_EEPROM
-	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
-	#define EEPROMEffectiveAddress		0xF00000
-	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
-#elif defined(__18F4455)||defined(__18F2455)
-	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
-	#define MaxPageToErase				383		 //Last 64 byte page of flash on the PIC18F4455
-	#define ProgramMemStop				0x006000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
-	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
-	#define	UserIDSize					8
-	#define	DEVICE_WITH_EEPROM
-	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
-	#define EEPROMEffectiveAddress		0xF00000
-	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
-#elif defined(__18F4458)||defined(__18F2458)
-	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
-	#define MaxPageToErase				383		 //Last 64 byte page of flash on the PIC18F4455
-	#define ProgramMemStop				0x006000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
-	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
-	#define	UserIDSize					8
-	#define	DEVICE_WITH_EEPROM
-	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
-	#define EEPROMEffectiveAddress		0xF00000
-	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
-
-#elif defined(__18F4450)||defined(__18F2450)
-	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
-	#define MaxPageToErase				255		 //Last 64 byte page of flash on the PIC18F4450
-	#define ProgramMemStop				0x004000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
-	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
-	#define	UserIDSize					8
-	#define	ProgramBlockSize			0x10	 //16 byte programming block size on the PIC18F4450/2450 family devices
-
-#elif defined(__18F14K50) || defined(__18LF14K50)
-	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
-	#define MaxPageToErase				255		 //Last 64 byte page of flash on the PIC18F4455
-	#define ProgramMemStop				0x004000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
-	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
-	#define	UserIDSize					8
-	#define	DEVICE_WITH_EEPROM
-	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
-	#define EEPROMEffectiveAddress		0xF00000
-    #define	ProgramBlockSize			0x10	 //16 byte programming block size on the PIC18F14K50 family devices
-#elif defined(__18F13K50) || defined(__18LF13K50)
-	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
-	#define MaxPageToErase				127		 //Last 64 byte page of flash on the PIC18F4455
-	#define ProgramMemStop				0x002000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
-	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
-	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
-	#define	UserIDSize					8
-	#define	DEVICE_WITH_EEPROM
-	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
-	#define EEPROMEffectiveAddress		0xF00000
-	#define	ProgramBlockSize			0x8	 //8 byte programming block size on the PIC18F14K50 family devices
-
-#endif
-
-//Switch State Variable Choices
-#define	QUERY_DEVICE				0x02	//Command that the host uses to learn about the device (what regions can be programmed, and what type of memory is the region)
-#define	UNLOCK_CONFIG				0x03	//Note, this command is used for both locking and unlocking the config bits (see the "//Unlock Configs Command Definitions" below)
-#define ERASE_DEVICE				0x04	//Host sends this command to start an erase operation.  Firmware controls which pages should be erased.
-#define PROGRAM_DEVICE				0x05	//If host is going to send a full RequestDataBlockSize to be programmed, it uses this command.
-#define	PROGRAM_COMPLETE			0x06	//If host send less than a RequestDataBlockSize to be programmed, or if it wished to program whatever was left in the buffer, it uses this command.
-#define GET_DATA					0x07	//The host sends this command in order to read out memory from the device.  Used during verify (and read/export hex operations)
-#define	RESET_DEVICE				0x08	//Resets the microcontroller, so it can update the config bits (if they were programmed, and so as to leave the bootloader (and potentially go back into the main application)
-
-//Unlock Configs Command Definitions
-#define UNLOCKCONFIG				0x00	//Sub-command for the ERASE_DEVICE command
-#define LOCKCONFIG					0x01	//Sub-command for the ERASE_DEVICE command
-
-//Query Device Response "Types" 
-#define	TypeProgramMemory			0x01	//When the host sends a QUERY_DEVICE command, need to respond by populating a list of valid memory regions that exist in the device (and should be programmed)
-#define TypeEEPROM					0x02
-#define TypeConfigWords				0x03
-#define	TypeEndOfTypeList			0xFF	//Sort of serves as a "null terminator" like number, which denotes the end of the memory region list has been reached.
-
-
-//BootState Variable States
-#define	Idle						0x00
-#define NotIdle						0x01
-
-//OtherConstants
-#define InvalidAddress				0xFFFFFFFF
-
-//Application and Microcontroller constants
-#define BytesPerAddressPIC18		0x01		//One byte per address.  PIC24 uses 2 bytes for each address in the hex file.
-
-#define	TotalPacketSize				0x40
-#define WORDSIZE					0x02	//PIC18 uses 2 byte words, PIC24 uses 3 byte words.
-#define RequestDataBlockSize 		0x3A	//Number of data bytes in a standard request to the PC.  Must be an even number from 2-58 (0x02-0x3A).  Larger numbers make better use of USB bandwidth and 
-											//yeild shorter program/verify times, but require more micrcontroller RAM for buffer space.
-#define BufferSize 					0x40
-
-/** I N C L U D E S **********************************************************/
-#include <p18cxxx.h>
-#include "typedefs.h"
-#include "usb.h"
-#include "io_cfg.h"             // I/O pin mapping
-
-
-typedef union 
-{
-		unsigned char Contents[64];
-
-		//General command (with data in it) packet structure used by PROGRAM_DEVICE and GET_DATA commands 		
-		struct{
-			unsigned char Command;
-			unsigned long Address;
-			unsigned char Size;
-//			unsigned char PadBytes[58-RequestDataBlockSize];	//Uncomment this if using a smaller than 0x3A RequestDataBlockSize.  Compiler doesn't like 0 byte array when using 58 byte data block size.
-			unsigned char Data[RequestDataBlockSize];
-		};
-		
-		//This struct used for responding to QUERY_DEVICE command (on a device with four programmable sections)
-		struct{
-			unsigned char Command;
-			unsigned char PacketDataFieldSize;
-			unsigned char BytesPerAddress;
-			unsigned char Type1;
-			unsigned long Address1;
-			unsigned long Length1;
-			unsigned char Type2;
-			unsigned long Address2;
-			unsigned long Length2;
-			unsigned char Type3;
-			unsigned long Address3;
-			unsigned long Length3;
-			unsigned char Type4;
-			unsigned long Address4;
-			unsigned long Length4;						
-			unsigned char Type5;
-			unsigned long Address5;
-			unsigned long Length5;
-			unsigned char Type6;
-			unsigned long Address6;
-			unsigned long Length6;			
-			unsigned char ExtraPadBytes[7];
-		};		
-		
-		struct{						//For UNLOCK_CONFIG command
-			unsigned char Command;
-			unsigned char LockValue;
-		};
-} PacketToFromPC;		
-	
-
-/** V A R I A B L E S ********************************************************/
-#pragma udata SomeSectionName1
-unsigned short long ProgramMemStopAddress;
-unsigned char BootState;
-unsigned int ErasePageTracker;
-unsigned char BufferedDataIndex;
-unsigned short long ProgrammedPointer;
-unsigned char ConfigsLockValue;
-unsigned char ProgrammingBuffer[BufferSize];
-
-#pragma udata SomeSectionName2
-PacketToFromPC PacketFromPC;
-#pragma udata SomeSectionName3
-PacketToFromPC PacketToPC;
-
-/** P R I V A T E  P R O T O T Y P E S ***************************************/
-void BlinkUSBStatus(void);
-void UserInit(void);
-void WriteFlashBlock(void);
-void WriteConfigBits(void);
-void WriteEEPROM(void);
-void UnlockAndActivate(void);
-
-
-
-/** D E C L A R A T I O N S **************************************************/
-#pragma code
-void UserInit(void)
-{
-    mInitAllLEDs();		//Init them off.
-
-	//Initialize bootloader state variables
-	BootState = Idle;
-	ProgrammedPointer = InvalidAddress;	
-	BufferedDataIndex = 0;
-	ConfigsLockValue = TRUE;
-}//end UserInit
-
-
-/******************************************************************************
- * Function:        void ProcessIO(void)
- *
- * PreCondition:    None
- *
- * Input:           None
- *
- * Output:          None
- *
- * Side Effects:    None
- *
- * Overview:        This function is a place holder for other user routines.
- *                  It is a mixture of both USB and non-USB tasks.
- *
- * Note:            None
- *****************************************************************************/
-void ProcessIO(void)
-{
-	unsigned char i;
-
-	if(BootState == Idle)
-	{
-		if(!mHIDRxIsBusy())	//Did we receive a command?
-		{
-			HIDRxReport((char *)&PacketFromPC, 64);
-			BootState = NotIdle;
-			
-			for(i = 0; i < TotalPacketSize; i++)		//Prepare the next packet we will send to the host, by initializing the entire packet to 0x00.
-				PacketToPC.Contents[i] = 0;				//This saves code space, since we don't have to do it independently in the QUERY_DEVICE and GET_DATA cases.
-		}
-	}
-	else //(BootState must be NotIdle)
-	{	
-		switch(PacketFromPC.Command)
-		{
-			case QUERY_DEVICE:
-			{
-				//Prepare a response packet, which lets the PC software know about the memory ranges of this device.
-				PacketToPC.Command = QUERY_DEVICE;
-				PacketToPC.PacketDataFieldSize = RequestDataBlockSize;
-				PacketToPC.BytesPerAddress = BytesPerAddressPIC18;
-				PacketToPC.Type1 = TypeProgramMemory;
-				PacketToPC.Address1 = (unsigned long)ProgramMemStart;
-				PacketToPC.Length1 = (unsigned long)(ProgramMemStop - ProgramMemStart);	//Size of program memory area
-				PacketToPC.Type2 = TypeConfigWords;
-				PacketToPC.Address2 = (unsigned long)ConfigWordsStartAddress;
-				PacketToPC.Length2 = (unsigned long)ConfigWordsSectionLength;
-				PacketToPC.Type3 = TypeProgramMemory;		//Not really program memory (User ID), but may be treated as it it was as far as the host is concerned
-				PacketToPC.Address3 = (unsigned long)UserIDAddress;
-				PacketToPC.Length3 = (unsigned long)(UserIDSize);
-				PacketToPC.Type4 = TypeEndOfTypeList;
-				#if defined(DEVICE_WITH_EEPROM)
-					PacketToPC.Type4 = TypeEEPROM;
-					PacketToPC.Address4 = (unsigned long)EEPROMEffectiveAddress;
-					PacketToPC.Length4 = (unsigned long)EEPROMSize;
-					PacketToPC.Type5 = TypeEndOfTypeList;
-				#endif
-				//Init pad bytes to 0x00...  Already done after we received the QUERY_DEVICE command (just after calling HIDRxReport()).
-	
-				if(!mHIDTxIsBusy())
-				{
-					HIDTxReport((char *)&PacketToPC, 64);
-					BootState = Idle;
-				}
-			}
-				break;
-			case UNLOCK_CONFIG:
-			{
-				ConfigsLockValue = TRUE;
-				if(PacketFromPC.LockValue == UNLOCKCONFIG)
-				{
-					ConfigsLockValue = FALSE;
-				}
-				BootState = Idle;
-			}
-				break;
-			case ERASE_DEVICE:
-			{
-				//First erase main program flash memory
-				for(ErasePageTracker = StartPageToErase; ErasePageTracker < (unsigned int)(MaxPageToErase + 1); ErasePageTracker++)
-				{
-					ClrWdt();
-					TBLPTR = ((unsigned short long)ErasePageTracker << 6);
-					EECON1 = 0b10010100;	//Prepare for erasing flash memory
-					UnlockAndActivate();
-					USBDriverService(); 	//Call USBDriverService() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
-				}
-				
-				#if defined(DEVICE_WITH_EEPROM)
-				//Now erase EEPROM (if any is present on the device)
-				i = EEPROMEffectiveAddress & (EEPROMSize-1);
-				do{
-					EEADR = i;
-					EEDATA = 0xFF;
-					EECON1 = 0b00000100;	//EEPROM Write mode
-					USBDriverService(); 	//Call USBDriverService() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
-					UnlockAndActivate();					
-				}while(i++<((EEPROMSize-1)+(EEPROMEffectiveAddress & (EEPROMSize-1))));
-				#endif
-
-				//Now erase the User ID space (0x200000 to 0x200007)
-				TBLPTR = UserIDAddress;
-				EECON1 = 0b10010100;	//Prepare for erasing flash memory
-				UnlockAndActivate();
-
-				BootState = Idle;				
-			}
-				break;
-			case PROGRAM_DEVICE:
-			{
-				//Check if host is trying to program the config bits
-				if(PacketFromPC.Contents[3] == 0x30) // 			//PacketFromPC.Contents[3] is bits 23:16 of the address.  
-				{													//0x30 implies config bits
-					if(ConfigsLockValue == FALSE)
-					{
-						WriteConfigBits();		//Doesn't get reprogrammed if the UNLOCK_CONFIG (LockValue = UNLOCKCONFIG) command hasn't previously been sent
-					}
-					BootState = Idle;
-					break;
-				}
-
-				#if defined(DEVICE_WITH_EEPROM)
-				//Check if host is trying to program the EEPROM
-				if(PacketFromPC.Contents[3] == 0xF0)	//PacketFromPC.Contents[3] is bits 23:16 of the address.  
-				{										//0xF0 implies EEPROM
-					WriteEEPROM();
-					BootState = Idle;
-					break;
-				}
-				#endif
-
-				if(ProgrammedPointer == (unsigned short long)InvalidAddress)
-					ProgrammedPointer = PacketFromPC.Address;
-				
-				if(ProgrammedPointer == (unsigned short long)PacketFromPC.Address)
-				{
-					for(i = 0; i < PacketFromPC.Size; i++)
-					{
-						ProgrammingBuffer[BufferedDataIndex] = PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)];	//Data field is right justified.  Need to put it in the buffer left justified.
-						BufferedDataIndex++;
-						ProgrammedPointer++;
-						if(BufferedDataIndex == ProgramBlockSize)
-						{
-							WriteFlashBlock();
-						}
-					}
-				}
-				//else host sent us a non-contiguous packet address...  to make this firmware simpler, host should not do this without sending a PROGRAM_COMPLETE command in between program sections.
-				BootState = Idle;
-			}
-				break;
-			case PROGRAM_COMPLETE:
-			{
-				WriteFlashBlock();
-				ProgrammedPointer = InvalidAddress;		//Reinitialize pointer to an invalid range, so we know the next PROGRAM_DEVICE will be the start address of a contiguous section.
-				BootState = Idle;
-			}
-				break;
-			case GET_DATA:
-			{
-				//Init pad bytes to 0x00...  Already done after we received the QUERY_DEVICE command (just after calling HIDRxReport()).
-				PacketToPC.Command = GET_DATA;
-				PacketToPC.Address = PacketFromPC.Address;
-				PacketToPC.Size = PacketFromPC.Size;
-
-
-				TBLPTR = (unsigned short long)PacketFromPC.Address;
-				for(i = 0; i < PacketFromPC.Size; i++)
-				{
-					if(PacketFromPC.Contents[3] == 0xF0)	//PacketFromPC.Contents[3] is bits 23:16 of the address.  
-					{										//0xF0 implies EEPROM, which doesn't use the table pointer to read from
-						#if defined(DEVICE_WITH_EEPROM)
-						EEADR = (((unsigned char)PacketFromPC.Address) + i);	//The bits 7:0 are 1:1 mapped to the EEPROM address space values
-						EECON1 = 0b00000000;	//EEPROM read mode
-						EECON1bits.RD = 1;
-						PacketToPC.Data[i+((TotalPacketSize - 6) - PacketFromPC.Size)] = EEDATA;					
-						#endif
-					}
-					else	//else must have been a normal program memory region, or one that can be read from with the table pointer
-					{
-    					_asm
-						tblrdpostinc
-						_endasm
-
-                        //since 0x300004 and 0x300007 are not implemented we need to return 0xFF
-                        //  since the device reads 0x00 but the hex file has 0x00
-                        if(TBLPTRU == 0x30)
-                        {
-                            if(TBLPTRL == 0x05)
-                                TABLAT = 0xFF;
-                            if(TBLPTRL == 0x08)
-                                TABLAT = 0xFF;
-                        }
-                        PacketToPC.Data[i+((TotalPacketSize - 6) - PacketFromPC.Size)]=TABLAT;
-					}
-				}
-
-				if(!mHIDTxIsBusy())
-				{
-					HIDTxReport((char *)&PacketToPC, 64);
-					BootState = Idle;
-				}
-			}
-				break;
-			case RESET_DEVICE:
-			{
-				UCONbits.SUSPND = 0;		//Disable USB module
-				UCON = 0x00;				//Disable USB module
-				//And wait awhile for the USB cable capacitance to discharge down to disconnected (SE0) state. 
-				//Otherwise host might not realize we disconnected/reconnected when we do the reset.
-				//A basic for() loop decrementing a 16 bit number would be simpler, but seems to take more code space for
-				//a given delay.  So do this instead:
-				for(i = 0; i < 0xFF; i++)
-				{
-					WREG = 0xFF;
-					while(WREG)
-					{
-						WREG--;
-						_asm
-						bra	0	//Equivalent to bra $+2, which takes half as much code as 2 nop instructions
-						bra	0	//Equivalent to bra $+2, which takes half as much code as 2 nop instructions
-						_endasm	
-					}
-				}
-				Reset();
-			}
-				break;
-		}//End switch
-	}//End if/else
-
-}//End ProcessIO()
-
-
-void WriteFlashBlock(void)		//Use to write blocks of data to flash.
-{
-    static unsigned char i;
-	static unsigned char BytesTakenFromBuffer;
-	static unsigned char CorrectionFactor;
-
-    BytesTakenFromBuffer = 0;
-	TBLPTR = (ProgrammedPointer - BufferedDataIndex);
-
-	//Check the lower 5 bits of the TBLPTR to verify it is pointing to a 32 byte aligned block (5 LSb = 00000).
-	//If it isn't, need to somehow make it so before doing the actual loading of the programming latches.
-	//In order to maximize programming speed, the PC application meant to be used with this firmware will not send 
-	//large blocks of 0xFF bytes.  If the PC application
-	//detects a large block of unprogrammed space in the hex file (effectively = 0xFF), it will skip over that
-	//section and will not send it to the firmware.  This works, because the firmware will have already done an
-	//erase on that section of memory when it received the ERASE_DEVICE command from the PC.  Therefore, the section
-	//can be left unprogrammed (after an erase the flash ends up = 0xFF).
-	//This can result in a problem however, in that the next genuine non-0xFF section in the hex file may not start 
-	//on a 32 byte aligned block boundary.  This needs to be handled with care since the microcontroller can only 
-	//program 32 byte blocks that are aligned with 32 byte boundaries.
-	//So, use the below code to avoid this potential issue.
-
-	#if(ProgramBlockSize == 0x20)
-		CorrectionFactor = (TBLPTRL & 0b00011111);	//Correctionfactor = number of bytes tblptr must go back to find the immediate preceeding 32 byte boundary
-		TBLPTRL &= 0b11100000;						//Move the table pointer back to the immediately preceeding 32 byte boundary
-	#elif(ProgramBlockSize == 0x10)
-		CorrectionFactor = (TBLPTRL & 0b00001111);	//Correctionfactor = number of bytes tblptr must go back to find the immediate preceeding 16 byte boundary
-		TBLPTRL &= 0b11110000;						//Move the table pointer back to the immediately preceeding 16 byte boundary
-	#elif(ProgramBlockSize == 0x8)
-		CorrectionFactor = (TBLPTRL & 0b00000111);	//Correctionfactor = number of bytes tblptr must go back to find the immediate preceeding 16 byte boundary
-		TBLPTRL &= 0b11111000;						//Move the table pointer back to the immediately preceeding 16 byte boundary
-	#else
-		#error Double click this error message and fix this section for your microcontroller type.
-	#endif
-
-	for(i = 0; i < ProgramBlockSize; i++)	//Load the programming latches
-	{
-		if(CorrectionFactor == 0)
-		{
-			if(BufferedDataIndex != 0)	//If the buffer isn't empty
-			{
-				TABLAT = ProgrammingBuffer[BytesTakenFromBuffer];
-				_asm tblwtpostinc _endasm
-				BytesTakenFromBuffer++;
-				BufferedDataIndex--;	//Used up a byte from the buffer.
-			}
-			else	//No more data in buffer, need to write 0xFF to fill the rest of the programming latch locations
-			{
-				TABLAT = 0xFF;
-				_asm tblwtpostinc _endasm				
-			}
-		}
-		else
-		{
-			TABLAT = 0xFF;
-			_asm tblwtpostinc _endasm
-			CorrectionFactor--;
-		}
-	}
-
-//	TBLPTR--;		//Need to make table pointer point to the region which will be programmed before initiating the programming operation
-	_asm tblrdpostdec _endasm	//Do this instead of TBLPTR--; since it takes less code space.
-		
-	EECON1 = 0b10100100;	//flash programming mode
-	UnlockAndActivate();
-
-	//Now need to fix the ProgrammingBuffer[].  We may not have taken a full 32 bytes out of the buffer.  In this case,
-	//the data is no longer justified correctly.
-	for(i = 0; i < BufferedDataIndex; i++)	//Need to rejustify the remaining data to the "left" of the buffer (if there is any left)
-	{
-		ProgrammingBuffer[i] = ProgrammingBuffer[BytesTakenFromBuffer+i];
-	}
-}
-
-
-void WriteConfigBits(void)	//Also used to write the Device ID
-{
-	static unsigned char i;
-
-	TBLPTR = (unsigned short long)PacketFromPC.Address;
-
-	for(i = 0; i < PacketFromPC.Size; i++)
-	{
-		TABLAT = PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)];
-		_asm
-		tblwt
-		_endasm
-
-		EECON1 = 0b11000100;	//Config bits programming mode
-		UnlockAndActivate();
-
-		_asm
-		tblrdpostinc
-		_endasm
-	}
-}
-
-#if defined(DEVICE_WITH_EEPROM)
-void WriteEEPROM(void)
-{
-	static unsigned char i;
-	
-	for(i = 0; i < PacketFromPC.Size; i++)
-	{
-		EEADR = (((unsigned char)PacketFromPC.Address) + i);
-		EEDATA = PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)];
-
-		EECON1 = 0b00000100;	//EEPROM Write mode
-		UnlockAndActivate();
-	}
-
-}
-#endif
-
-void UnlockAndActivate(void)
-{
-	INTCONbits.GIE = 0;		//Make certain interrupts disabled for unlock process.
-	_asm
-	//Now unlock sequence to set WR (make sure interrupts are disabled before executing this)
-	MOVLW 0x55
-	MOVWF EECON2, 0
-	MOVLW 0xAA
-	MOVWF EECON2, 0
-	BSF EECON1, 1, 0		//Performs write
-	_endasm	
-	while(EECON1bits.WR);	//Wait until complete (relevant when programming EEPROM, not important when programming flash since processor stalls during flash program)	
-	EECON1bits.WREN = 0;  	//Good practice now to clear the WREN bit, as further protection against any accidental activation of self write/erase operations.
-}	
-
-/** EOF Boot4450Family.c *********************************************************/
+/*********************************************************************
+ *
+ *   Microchip USB HID Bootloader for PIC18F and PIC18LF versions of:
+ *	 PIC18F4553/4458/2553/2458
+ *	 PIC18F4550/4455/2550/2455
+ *	 PIC18F4450/2450
+ *   PIC18F14K50/13K50
+ *
+ *********************************************************************
+ * FileName:        BootPIC18NonJ.c
+ * Dependencies:    See INCLUDES section below
+ * Processor:       PIC18
+ * Compiler:        C18 3.32+
+ * Company:         Microchip Technology, Inc.
+ *
+ * Software License Agreement
+ *
+ * The software supplied herewith by Microchip Technology Incorporated
+ * (the Company) for its PICmicro® Microcontroller is intended and
+ * supplied to you, the Companys customer, for use solely and
+ * exclusively on Microchip PICmicro Microcontroller products. The
+ * software is owned by the Company and/or its supplier, and is
+ * protected under applicable copyright laws. All rights are reserved.
+ * Any use in violation of the foregoing restrictions may subject the
+ * user to criminal sanctions under applicable laws, as well as to
+ * civil liability for the breach of the terms and conditions of this
+ * license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * File version         Date        Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * 1.0					06/19/08	Original Version.  Adapted from 
+ *									MCHPFSUSB v2.1 HID Bootloader
+ *									for PIC18F87J50 Family devices.
+ *********************************************************************/
+
+/** C O N S T A N T S **********************************************************/
+
+//Section defining the address range to erase for the erase device command, along with the valid programming range to be reported by the QUERY_DEVICE command.
+#define ProgramMemStart					0x001000 //Beginning of application program memory (not occupied by bootloader).  **THIS VALUE MUST BE ALIGNED WITH 64 BYTE BLOCK BOUNDRY** Also, in order to work correctly, make sure the StartPageToErase is set to erase this section.
+
+#if defined(__18F4550)||defined(__18F2550)
+	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
+	#define MaxPageToErase				511		 //Last 64 byte page of flash on the PIC18F4550
+	#define ProgramMemStop				0x008000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
+	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
+	#define	UserIDSize					8
+	#define	DEVICE_WITH_EEPROM
+	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
+	#define EEPROMEffectiveAddress		0xF00000
+	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
+#elif defined(__18F4553)||defined(__18F2553)
+	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
+	#define MaxPageToErase				511		 //Last 64 byte page of flash on the PIC18F4550
+	#define ProgramMemStop				0x008000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
+	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
+	#define	UserIDSize					8
+	#define	DEVICE_WITH_EEPROM
+	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
+	#define EEPROMEffectiveAddress		0xF00000
+	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
+#elif defined(__18F4455)||defined(__18F2455)
+	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
+	#define MaxPageToErase				383		 //Last 64 byte page of flash on the PIC18F4455
+	#define ProgramMemStop				0x006000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
+	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
+	#define	UserIDSize					8
+	#define	DEVICE_WITH_EEPROM
+	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
+	#define EEPROMEffectiveAddress		0xF00000
+	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
+#elif defined(__18F4458)||defined(__18F2458)
+	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
+	#define MaxPageToErase				383		 //Last 64 byte page of flash on the PIC18F4455
+	#define ProgramMemStop				0x006000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
+	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
+	#define	UserIDSize					8
+	#define	DEVICE_WITH_EEPROM
+	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
+	#define EEPROMEffectiveAddress		0xF00000
+	#define	ProgramBlockSize			0x20	 //32 byte programming block size on the PIC18F4550/PIC18F4553 family devices
+
+#elif defined(__18F4450)||defined(__18F2450)
+	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
+	#define MaxPageToErase				255		 //Last 64 byte page of flash on the PIC18F4450
+	#define ProgramMemStop				0x004000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
+	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
+	#define	UserIDSize					8
+	#define	ProgramBlockSize			0x10	 //16 byte programming block size on the PIC18F4450/2450 family devices
+
+#elif defined(__18F14K50) || defined(__18LF14K50)
+	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
+	#define MaxPageToErase				255		 //Last 64 byte page of flash on the PIC18F4455
+	#define ProgramMemStop				0x004000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
+	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
+	#define	UserIDSize					8
+	#define	DEVICE_WITH_EEPROM
+	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
+	#define EEPROMEffectiveAddress		0xF00000
+    #define	ProgramBlockSize			0x10	 //16 byte programming block size on the PIC18F14K50 family devices
+#elif defined(__18F13K50) || defined(__18LF13K50)
+	#define StartPageToErase			64		 //The 4096 byte section from 0x000-0xFFF contains the bootloader and will not be erased
+	#define MaxPageToErase				127		 //Last 64 byte page of flash on the PIC18F4455
+	#define ProgramMemStop				0x002000 //**MUST BE WORD ALIGNED (EVEN) ADDRESS.  This address does not get updated, but the one just below it does: IE: If AddressToStopPopulating = 0x200, 0x1FF is the last programmed address (0x200 not programmed)**	
+	#define ConfigWordsStartAddress		0x300000 //0x300000 is CONFIG space for PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define ConfigWordsSectionLength	14   	 //14 bytes worth of Configuration words on the PIC18F4550/PIC18F4553/PIC18F4450 family devices
+	#define UserIDAddress				0x200000 //User ID is 8 bytes starting at 0x200000
+	#define	UserIDSize					8
+	#define	DEVICE_WITH_EEPROM
+	#define	EEPROMSize					0x100	 //256 bytes of EEPROM on this device
+	#define EEPROMEffectiveAddress		0xF00000
+	#define	ProgramBlockSize			0x8	 //8 byte programming block size on the PIC18F14K50 family devices
+
+#endif
+
+//Optional protocol extensions.  The host learns which of these are present from the ExtendedFeatures field of the
+//QUERY_DEVICE response (always 0x0000 in a build without any of them), so hosts that don't know about them are unaffected.
+//NOTE: Each of these adds code.  The default build already occupies almost all of the 0x000-0xFFF boot block, so
+//enabling any of them also requires moving ProgramMemStart/StartPageToErase up, along with the BootPage/page
+//boundary in the linker script and the application vector remapping in main.c (and in the application projects).
+//#define USE_READ_STREAM_COMMAND				//READ_STREAM: read back an entire address range with a single request
+//#define USE_VERIFY_RANGE_COMMAND			//VERIFY_RANGE: CRC-16 of an address range, calculated on the device
+//#define USE_ERASE_RANGE_COMMAND				//ERASE_RANGE: erase only the pages (and optionally the EEPROM/User ID) an image actually uses
+//#define USE_BLANK_CHECK_ERASE				//ERASE_DEVICE/ERASE_RANGE skip flash rows, EEPROM bytes and the User ID when they are already blank
+//#define USE_COMPRESSED_PROGRAMMING			//PROGRAM_COMPRESSED: PROGRAM_DEVICE with a PackBits (RLE) compressed payload
+//#define USE_FILL_COMMAND					//FILL: program a run of one repeated value without sending it over USB
+//#define USE_AUTO_SECTION_PROGRAMMING		//PROGRAM_DEVICE accepts address jumps without a PROGRAM_COMPLETE between sections
+//#define USE_PATCH_COMMAND					//PATCH_DEVICE: read-modify-write of individual flash rows, without erasing the rest of the device
+//#define USE_BACKGROUND_ERASE				//ERASE_DEVICE/ERASE_RANGE return at once and erase one row per main loop pass, GET_ERASE_STATUS reports the progress
+//#define USE_LAZY_ERASE						//Each flash row gets erased just before the first write to it, so the host can skip ERASE_DEVICE
+//#define LAZY_ERASE_UNTOUCHED_ROWS			//With USE_LAZY_ERASE, PROGRAM_COMPLETE also erases the application rows that haven't been written, instead of leaving them as they are
+
+//Switch State Variable Choices
+#define	QUERY_DEVICE				0x02	//Command that the host uses to learn about the device (what regions can be programmed, and what type of memory is the region)
+#define	UNLOCK_CONFIG				0x03	//Note, this command is used for both locking and unlocking the config bits (see the "//Unlock Configs Command Definitions" below)
+#define ERASE_DEVICE				0x04	//Host sends this command to start an erase operation.  Firmware controls which pages should be erased.
+#define PROGRAM_DEVICE				0x05	//If host is going to send a full RequestDataBlockSize to be programmed, it uses this command.
+#define	PROGRAM_COMPLETE			0x06	//If host send less than a RequestDataBlockSize to be programmed, or if it wished to program whatever was left in the buffer, it uses this command.
+#define GET_DATA					0x07	//The host sends this command in order to read out memory from the device.  Used during verify (and read/export hex operations)
+#define	RESET_DEVICE				0x08	//Resets the microcontroller, so it can update the config bits (if they were programmed, and so as to leave the bootloader (and potentially go back into the main application)
+#define READ_STREAM					0x10	//The host sends a start address and a length, and the firmware answers with back to back GET_DATA style packets (each with its own address) until the whole range has been sent
+#define VERIFY_RANGE				0x11	//The host sends a start address and a length, and the firmware answers with a single packet containing the CRC-16 of that range
+#define ERASE_RANGE					0x12	//Like ERASE_DEVICE, but only erases the flash pages covering the requested address range, plus the EEPROM and/or User ID if requested in RangeFlags.  Answers with the number of flash pages actually erased.
+#define PROGRAM_COMPRESSED			0x13	//Same as PROGRAM_DEVICE (Address is the uncompressed address), but the Size bytes of data are a PackBits stream, which gets expanded into the ProgrammingBuffer.  Program memory and User ID only.
+#define FILL						0x14	//Programs Length copies of FillValue starting at Address, as if they had been sent with PROGRAM_DEVICE.  Program memory and User ID only.
+#define PATCH_DEVICE				0x15	//Same packet format as PROGRAM_DEVICE, but the surrounding 64 byte row(s) keep their existing contents.  Application program memory only.
+#define GET_ERASE_STATUS			0x16	//Not called GET_STATUS, usb9.h already uses that name for the standard USB request.  Answers right away (even while an erase is still running), with the progress of the last ERASE_DEVICE/ERASE_RANGE command
+
+//Unlock Configs Command Definitions
+#define UNLOCKCONFIG				0x00	//Sub-command for the ERASE_DEVICE command
+#define LOCKCONFIG					0x01	//Sub-command for the ERASE_DEVICE command
+
+//Erase Range Command "RangeFlags" bits
+#define EraseRangeEEPROM			0x01	//Also erase the entire EEPROM
+#define EraseRangeUserID			0x02	//Also erase the User ID space
+
+//Get Status Response "StatusFlags" bits
+#define StatusEraseBusy				0x01	//An ERASE_DEVICE/ERASE_RANGE command is still being carried out.  Commands that access memory are held off until it finishes.
+
+//Query Device Response "Types" 
+#define	TypeProgramMemory			0x01	//When the host sends a QUERY_DEVICE command, need to respond by populating a list of valid memory regions that exist in the device (and should be programmed)
+#define TypeEEPROM					0x02
+#define TypeConfigWords				0x03
+#define	TypeEndOfTypeList			0xFF	//Sort of serves as a "null terminator" like number, which denotes the end of the memory region list has been reached.
+
+//Query Device Response "ExtendedFeatures" bits, one for each optional protocol extension compiled into this build
+#define ExtReadStream				0x0001
+#define ExtVerifyRange				0x0002
+#define ExtEraseRange				0x0004
+#define ExtBlankCheckErase			0x0008
+#define ExtCompressedProgramming	0x0010
+#define ExtFill						0x0020
+#define ExtAutoSectionProgramming	0x0040
+#define ExtPatch					0x0080
+#define ExtBackgroundErase			0x0100
+#define ExtLazyErase				0x0200
+
+#if defined(USE_READ_STREAM_COMMAND)
+	#define ExtReadStreamSupport		ExtReadStream
+#else
+	#define ExtReadStreamSupport		0x0000
+#endif
+#if defined(USE_VERIFY_RANGE_COMMAND)
+	#define ExtVerifyRangeSupport		ExtVerifyRange
+#else
+	#define ExtVerifyRangeSupport		0x0000
+#endif
+#if defined(USE_ERASE_RANGE_COMMAND)
+	#define ExtEraseRangeSupport		ExtEraseRange
+#else
+	#define ExtEraseRangeSupport		0x0000
+	#define EraseStopPage				(unsigned int)(MaxPageToErase + 1)		//Without ERASE_RANGE, ERASE_DEVICE always erases everything
+	#define EraseFlags					(EraseRangeEEPROM | EraseRangeUserID)
+#endif
+#if defined(USE_BLANK_CHECK_ERASE)
+	#define ExtBlankCheckEraseSupport	ExtBlankCheckErase
+#else
+	#define ExtBlankCheckEraseSupport	0x0000
+#endif
+#if defined(USE_COMPRESSED_PROGRAMMING)
+	#define ExtCompressedProgrammingSupport	ExtCompressedProgramming
+#else
+	#define ExtCompressedProgrammingSupport	0x0000
+#endif
+#if defined(USE_FILL_COMMAND)
+	#define ExtFillSupport				ExtFill
+#else
+	#define ExtFillSupport				0x0000
+#endif
+#if defined(USE_AUTO_SECTION_PROGRAMMING)
+	#define ExtAutoSectionProgrammingSupport	ExtAutoSectionProgramming
+#else
+	#define ExtAutoSectionProgrammingSupport	0x0000
+#endif
+#if defined(USE_PATCH_COMMAND)
+	#define ExtPatchSupport				ExtPatch
+#else
+	#define ExtPatchSupport				0x0000
+#endif
+#if defined(USE_BACKGROUND_ERASE)
+	#define ExtBackgroundEraseSupport	ExtBackgroundErase
+#else
+	#define ExtBackgroundEraseSupport	0x0000
+#endif
+#if defined(USE_LAZY_ERASE)
+	#define ExtLazyEraseSupport			ExtLazyErase
+#else
+	#define ExtLazyEraseSupport			0x0000
+#endif
+#define ExtendedFeatureSupport		(ExtReadStreamSupport | ExtVerifyRangeSupport | ExtEraseRangeSupport | ExtBlankCheckEraseSupport | \
+									 ExtCompressedProgrammingSupport | ExtFillSupport | ExtAutoSectionProgrammingSupport | ExtPatchSupport | \
+									 ExtBackgroundEraseSupport | ExtLazyEraseSupport)
+
+#if defined(USE_LAZY_ERASE)
+	//One bit per erasable 64 byte flash row (StartPageToErase to MaxPageToErase), plus one for the User ID row, set once the row
+	//has been erased since the bootloader started (by the first write to it, or by ERASE_DEVICE/ERASE_RANGE)
+	#define LazyEraseUserIDRow			(MaxPageToErase + 1)
+	#define RowErasedMapSize			((LazyEraseUserIDRow - StartPageToErase + 8) / 8)
+	#define mRowErasedByte(Page)		RowErasedMap[((Page) - StartPageToErase) >> 3]
+	#define mRowErasedBit(Page)			(1 << (((Page) - StartPageToErase) & 0x07))
+	#define mMarkRowErased(Page)		mRowErasedByte(Page) |= mRowErasedBit(Page)
+	#define mClearRowErased(Page)		mRowErasedByte(Page) &= ~mRowErasedBit(Page)
+#endif
+
+#if defined(USE_ERASE_RANGE_COMMAND) || defined(USE_BLANK_CHECK_ERASE) || defined(USE_BACKGROUND_ERASE)
+	#define COUNT_ERASED_PAGES					//Keep track of how many flash pages the last erase operation actually erased
+#endif
+
+//VERIFY_RANGE checksum: CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, no reflection, no final XOR)
+#define VerifyCRCInitialValue		0xFFFF
+
+
+//BootState Variable States
+#define	Idle						0x00
+#define NotIdle						0x01
+
+//EraseState Variable States (USE_BACKGROUND_ERASE only)
+#define EraseIdle					0x00
+#define EraseFlashRows				0x01
+#define EraseEEPROMBytes			0x02
+#define EraseUserIDSpace			0x03
+
+//OtherConstants
+#define InvalidAddress				0xFFFFFFFF
+
+//Application and Microcontroller constants
+#define BytesPerAddressPIC18		0x01		//One byte per address.  PIC24 uses 2 bytes for each address in the hex file.
+
+#define	TotalPacketSize				0x40
+#define WORDSIZE					0x02	//PIC18 uses 2 byte words, PIC24 uses 3 byte words.
+#define RequestDataBlockSize 		0x3A	//Number of data bytes in a standard request to the PC.  Must be an even number from 2-58 (0x02-0x3A).  Larger numbers make better use of USB bandwidth and 
+											//yeild shorter program/verify times, but require more micrcontroller RAM for buffer space.
+#define BufferSize 					0x40
+
+/** I N C L U D E S **********************************************************/
+#include <p18cxxx.h>
+#include "typedefs.h"
+#include "usb.h"
+#include "io_cfg.h"             // I/O pin mapping
+
+//Table read/write instructions.  The host build (SK28A Host Tools/sim) gets these from its own p18cxxx.h instead.
+#if defined(__18CXX)
+	#define TblRdPostInc()					{_asm tblrdpostinc _endasm}
+	#define TblRdPostDec()					{_asm tblrdpostdec _endasm}
+	#define TblWtPostInc()					{_asm tblwtpostinc _endasm}
+	#define TblWt()							{_asm tblwt _endasm}
+#endif
+
+//Command transport.  The 64 byte command/response packets are identical whether they travel over the HID interrupt
+//endpoints or over the vendor class bulk endpoints (see USB_USE_HID/USB_USE_GEN in usbcfg.h).
+#if defined(USB_USE_GEN)
+	#define mBootRxIsBusy()					mUSBGenRxIsBusy()
+	#define mBootTxIsBusy()					mUSBGenTxIsBusy()
+	#define BootRxPacket(buffer, len)		USBGenRead(buffer, len)
+	#define BootTxPacket(buffer, len)		USBGenWrite(buffer, len)
+	#define mBootRxBufferAdr()				mUSBGenRxBufferAdr()
+	#define mBootTxBufferAdr()				mUSBGenTxBufferAdr()
+	#define BootRxRelease()					USBGenRxRelease()
+	#define BootTxSend(len)					USBGenSend(len)
+#else
+	#define mBootRxIsBusy()					mHIDRxIsBusy()
+	#define mBootTxIsBusy()					mHIDTxIsBusy()
+	#define BootRxPacket(buffer, len)		HIDRxReport(buffer, len)
+	#define BootTxPacket(buffer, len)		HIDTxReport(buffer, len)
+	#define mBootRxBufferAdr()				mHIDRxBufferAdr()
+	#define mBootTxBufferAdr()				mHIDTxBufferAdr()
+	#define BootRxRelease()					HIDRxRelease()
+	#define BootTxSend(len)					HIDTxSend(len)
+#endif
+
+//With USE_ZERO_COPY_PACKETS, commands are decoded and responses are built directly in the endpoint buffers in USB RAM,
+//instead of being copied to/from PacketFromPC/PacketToPC in general purpose RAM.  This saves two 64 byte copies per
+//packet, and the 128 bytes of RAM.  The catch: the OUT buffer stays owned by the CPU until the command has been
+//processed, so without USB_USE_PING_PONG (usbcfg.h) the host can't get the next packet in while flash is being written.
+//#define USE_ZERO_COPY_PACKETS
+#if defined(USE_ZERO_COPY_PACKETS)
+	#define PacketFromPC					(*(PacketToFromPC*)mBootRxBufferAdr())
+	#define PacketToPC						(*(PacketToFromPC*)mBootTxBufferAdr())
+	#undef BootTxPacket
+	#define BootTxPacket(buffer, len)		BootTxSend(len)			//The response is already in place
+#endif
+
+typedef union 
+{
+		unsigned char Contents[64];
+
+		//General command (with data in it) packet structure used by PROGRAM_DEVICE and GET_DATA commands 		
+		struct{
+			unsigned char Command;
+			dword Address;
+			unsigned char Size;
+//			unsigned char PadBytes[58-RequestDataBlockSize];	//Uncomment this if using a smaller than 0x3A RequestDataBlockSize.  Compiler doesn't like 0 byte array when using 58 byte data block size.
+			unsigned char Data[RequestDataBlockSize];
+		};
+		
+		//This struct used for responding to QUERY_DEVICE command (on a device with four programmable sections)
+		struct{
+			unsigned :8;					//Command
+			unsigned char PacketDataFieldSize;
+			unsigned char BytesPerAddress;
+			unsigned char Type1;
+			dword Address1;
+			dword Length1;
+			unsigned char Type2;
+			dword Address2;
+			dword Length2;
+			unsigned char Type3;
+			dword Address3;
+			dword Length3;
+			unsigned char Type4;
+			dword Address4;
+			dword Length4;						
+			unsigned char Type5;
+			dword Address5;
+			dword Length5;
+			unsigned char Type6;
+			dword Address6;
+			dword Length6;			
+			word ExtendedFeatures;		//Which optional protocol extensions are supported (see "ExtendedFeatures" bits above)
+			unsigned char ExtraPadBytes[5];
+		};		
+
+		struct{						//For READ_STREAM, VERIFY_RANGE, ERASE_RANGE and FILL commands
+			unsigned char CommandAndAddress[5];	//Command and Address, as in the general command packet.  Only C18 accepts a member name twice.
+			dword Length;
+			unsigned char RangeFlags;	//Only used by ERASE_RANGE
+			word Checksum;		//Only used in the VERIFY_RANGE response
+			word ErasedPages;	//Only used in the ERASE_RANGE response
+			unsigned char FillValue;	//Only used by FILL
+		};
+		
+		struct{						//For the GET_ERASE_STATUS response
+			unsigned :8;					//Command
+			unsigned char StatusFlags;
+			word ErasePagesDone;		//Flash pages of the current (or last) erase range already processed
+			word ErasePagesRemaining;	//Flash pages still to go.  0 once the EEPROM/User ID part of the erase is reached.
+			word ErasedPageTotal;		//Of the pages done, how many actually needed erasing (see USE_BLANK_CHECK_ERASE)
+		};
+
+		struct{						//For UNLOCK_CONFIG command
+			unsigned :8;					//Command
+			unsigned char LockValue;
+		};
+} PacketToFromPC;		
+	
+
+/** V A R I A B L E S ********************************************************/
+#pragma udata SomeSectionName1
+UINT24 ProgramMemStopAddress;
+unsigned char BootState;
+unsigned int ErasePageTracker;
+unsigned char BufferedDataIndex;
+UINT24 ProgrammedPointer;
+unsigned char ConfigsLockValue;
+unsigned char ProgrammingBuffer[BufferSize];
+#if defined(USE_ERASE_RANGE_COMMAND)
+unsigned int EraseStopPage;
+unsigned char EraseFlags;
+#endif
+#if defined(COUNT_ERASED_PAGES)
+unsigned int ErasedPageCount;
+#endif
+#if defined(USE_BACKGROUND_ERASE)
+unsigned char EraseState;
+unsigned int EraseStartPage;
+unsigned char EraseEEPROMIndex;
+#endif
+
+#if defined(USE_LAZY_ERASE)
+#pragma udata SomeSectionName4
+unsigned char RowErasedMap[RowErasedMapSize];
+#endif
+
+#if !defined(USE_ZERO_COPY_PACKETS)
+#pragma udata SomeSectionName2
+PacketToFromPC PacketFromPC;
+#pragma udata SomeSectionName3
+PacketToFromPC PacketToPC;
+#endif
+
+/** P R I V A T E  P R O T O T Y P E S ***************************************/
+void BlinkUSBStatus(void);
+void UserInit(void);
+void WriteFlashBlock(void);
+void WriteConfigBits(void);
+void WriteEEPROM(void);
+void UnlockAndActivate(void);
+void ReadMemoryToPacket(void);
+BOOL IsFlashBlank(unsigned char Length);
+void BufferProgramByte(unsigned char Value);
+UINT24 WritableRangeEnd(void);
+BOOL IsFillInRange(void);
+void ExpandCompressedPacket(void);
+void SeekProgrammedPointer(void);
+void PatchFlashRows(void);
+unsigned char ReadNextByte(void);
+unsigned int CalculateRangeCRC(void);
+void EraseNextUnit(void);
+void LazyEraseRow(void);
+#if defined(USE_SERIAL_NUMBER_STRING)
+void BuildSerialNumberString(void);
+#endif
+
+
+
+/** D E C L A R A T I O N S **************************************************/
+#pragma code
+void UserInit(void)
+{
+	#if defined(USE_LAZY_ERASE)
+	unsigned char i;
+	#endif
+
+    mInitAllLEDs();		//Init them off.
+
+	//Initialize bootloader state variables
+	BootState = Idle;
+	ProgrammedPointer = InvalidAddress;	
+	BufferedDataIndex = 0;
+	ConfigsLockValue = TRUE;
+	#if defined(USE_BACKGROUND_ERASE)
+	EraseState = EraseIdle;
+	EraseStartPage = StartPageToErase;		//So GET_ERASE_STATUS reports 0 pages done before the first erase
+	ErasePageTracker = StartPageToErase;
+	ErasedPageCount = 0;
+	#endif
+	#if defined(USE_LAZY_ERASE)
+	for(i = 0; i < RowErasedMapSize; i++)
+		RowErasedMap[i] = 0;		//Nothing is known to be erased yet
+	#endif
+	#if defined(USE_SERIAL_NUMBER_STRING)
+	BuildSerialNumberString();		//Before the host can ask for it.  A new User ID shows after the next reset.
+	#endif
+}//end UserInit
+
+
+/******************************************************************************
+ * Function:        void ProcessIO(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        This function is a place holder for other user routines.
+ *                  It is a mixture of both USB and non-USB tasks.
+ *
+ * Note:            None
+ *****************************************************************************/
+void ProcessIO(void)
+{
+	unsigned char i;
+
+	#if defined(USE_BACKGROUND_ERASE)
+	if(EraseState != EraseIdle)
+		EraseNextUnit();		//One flash row (or EEPROM byte) per pass, so the main loop gets to service USB in between
+	#endif
+
+	if(BootState == Idle)
+	{
+		if(!mBootRxIsBusy())	//Did we receive a command?
+		{
+			#if defined(USE_ZERO_COPY_PACKETS)
+			//The response gets built right in the IN buffer, so it has to be free before the command can be started.
+			//PROGRAM_DEVICE, by far the most common command, never responds, so it doesn't need to wait.
+			if((PacketFromPC.Command != PROGRAM_DEVICE) && mBootTxIsBusy())
+				return;
+			#else
+			//BootRxPacket() copies the report into PacketFromPC and then immediately gives the OUT buffer back to the SIE.
+			//This means the next report from the host (ex: the next PROGRAM_DEVICE packet) can already be landing in USB RAM
+			//while this one is being processed, including while the CPU is stalled in WriteFlashBlock()/UnlockAndActivate().
+			BootRxPacket((char *)&PacketFromPC, 64);
+			#endif
+			BootState = NotIdle;
+
+			if(PacketFromPC.Command != PROGRAM_DEVICE)		//PROGRAM_DEVICE never responds, so don't bother preparing a response for it
+			{
+				for(i = 0; i < TotalPacketSize; i++)		//Prepare the next packet we will send to the host, by initializing the entire packet to 0x00.
+					PacketToPC.Contents[i] = 0;				//This saves code space, since we don't have to do it independently in the QUERY_DEVICE and GET_DATA cases.
+			}
+		}
+	}
+
+	if(BootState == NotIdle)	//Process the command in the same pass it was received in, so the OUT buffer gets serviced again as soon as possible
+	{
+		#if defined(USE_BACKGROUND_ERASE)
+		//While an erase is running, only commands that don't access the memory get through.  Anything else (typically the
+		//host's first PROGRAM_DEVICE) waits here until the erase is done, which the host just sees as the OUT endpoint NAKing.
+		if((EraseState != EraseIdle) && (PacketFromPC.Command >= ERASE_DEVICE) && (PacketFromPC.Command != RESET_DEVICE) && (PacketFromPC.Command != GET_ERASE_STATUS))
+			return;
+		#endif
+
+		switch(PacketFromPC.Command)
+		{
+			case QUERY_DEVICE:
+			{
+				//Prepare a response packet, which lets the PC software know about the memory ranges of this device.
+				PacketToPC.Command = QUERY_DEVICE;
+				PacketToPC.PacketDataFieldSize = RequestDataBlockSize;
+				PacketToPC.BytesPerAddress = BytesPerAddressPIC18;
+				PacketToPC.Type1 = TypeProgramMemory;
+				PacketToPC.Address1 = (unsigned long)ProgramMemStart;
+				PacketToPC.Length1 = (unsigned long)(ProgramMemStop - ProgramMemStart);	//Size of program memory area
+				PacketToPC.Type2 = TypeConfigWords;
+				PacketToPC.Address2 = (unsigned long)ConfigWordsStartAddress;
+				PacketToPC.Length2 = (unsigned long)ConfigWordsSectionLength;
+				PacketToPC.Type3 = TypeProgramMemory;		//Not really program memory (User ID), but may be treated as it it was as far as the host is concerned
+				PacketToPC.Address3 = (unsigned long)UserIDAddress;
+				PacketToPC.Length3 = (unsigned long)(UserIDSize);
+				PacketToPC.Type4 = TypeEndOfTypeList;
+				#if defined(DEVICE_WITH_EEPROM)
+					PacketToPC.Type4 = TypeEEPROM;
+					PacketToPC.Address4 = (unsigned long)EEPROMEffectiveAddress;
+					PacketToPC.Length4 = (unsigned long)EEPROMSize;
+					PacketToPC.Type5 = TypeEndOfTypeList;
+				#endif
+				#if(ExtendedFeatureSupport != 0)
+					PacketToPC.ExtendedFeatures = ExtendedFeatureSupport;
+				#endif
+				//Init pad bytes to 0x00...  Already done after we received the QUERY_DEVICE command (just after calling BootRxPacket()).
+	
+				if(!mBootTxIsBusy())
+				{
+					BootTxPacket((char *)&PacketToPC, 64);
+					BootState = Idle;
+				}
+			}
+				break;
+			case UNLOCK_CONFIG:
+			{
+				ConfigsLockValue = TRUE;
+				if(PacketFromPC.LockValue == UNLOCKCONFIG)
+				{
+					ConfigsLockValue = FALSE;
+				}
+				BootState = Idle;
+			}
+				break;
+			case ERASE_DEVICE:
+			#if defined(USE_ERASE_RANGE_COMMAND)
+			case ERASE_RANGE:
+			#endif
+			{
+				ErasePageTracker = StartPageToErase;
+				#if defined(USE_ERASE_RANGE_COMMAND)
+				if((PacketFromPC.Command == ERASE_RANGE) && mBootTxIsBusy())
+					break;	//ERASE_RANGE sends a response, so don't start until the IN endpoint is free to send it
+				EraseStopPage = MaxPageToErase + 1;
+				EraseFlags = EraseRangeEEPROM | EraseRangeUserID;
+				if(PacketFromPC.Command == ERASE_RANGE)
+				{
+					//Convert the address range into the pages that cover it, but never go outside of the normally erased area (the bootloader must not erase itself)
+					if(ErasePageTracker < (unsigned int)(PacketFromPC.Address >> 6))
+						ErasePageTracker = (unsigned int)(PacketFromPC.Address >> 6);
+					if(EraseStopPage > (unsigned int)((PacketFromPC.Address + PacketFromPC.Length + 63) >> 6))
+						EraseStopPage = (unsigned int)((PacketFromPC.Address + PacketFromPC.Length + 63) >> 6);
+					EraseFlags = PacketFromPC.RangeFlags;
+				}
+				#endif
+				#if defined(COUNT_ERASED_PAGES)
+				ErasedPageCount = 0;
+				#endif
+
+				#if defined(USE_BACKGROUND_ERASE)
+				EraseStartPage = ErasePageTracker;
+				#if defined(DEVICE_WITH_EEPROM)
+				EraseEEPROMIndex = EEPROMEffectiveAddress & (EEPROMSize-1);
+				#endif
+				EraseState = EraseFlashRows;	//EraseNextUnit() takes it from here.  The ERASE_RANGE response below goes out right away, so its ErasedPages is 0 (see GET_ERASE_STATUS instead).
+				#else
+				//First erase main program flash memory
+				for(; ErasePageTracker < EraseStopPage; ErasePageTracker++)
+				{
+					ClrWdt();
+					TBLPTR = ((UINT24)ErasePageTracker << 6);
+					#if defined(USE_LAZY_ERASE)
+					mMarkRowErased(ErasePageTracker);
+					#endif
+					#if defined(USE_BLANK_CHECK_ERASE)
+					if(IsFlashBlank(64))	//Already erased?  Then don't spend the time (and the endurance) erasing it again.
+						continue;
+					TBLPTR = ((UINT24)ErasePageTracker << 6);
+					#endif
+					EECON1 = 0b10010100;	//Prepare for erasing flash memory
+					UnlockAndActivate();
+					#if defined(COUNT_ERASED_PAGES)
+					ErasedPageCount++;
+					#endif
+					mUSBDriverServicePoll(); 	//Call USBDriverService() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
+				}
+				
+				#if defined(DEVICE_WITH_EEPROM)
+				//Now erase EEPROM (if any is present on the device)
+				if(EraseFlags & EraseRangeEEPROM)
+				{
+					i = EEPROMEffectiveAddress & (EEPROMSize-1);
+					do{
+						EEADR = i;
+						#if defined(USE_BLANK_CHECK_ERASE)
+						EECON1 = 0b00000000;	//EEPROM read mode
+						EECON1bits.RD = 1;
+						if(EEDATA == 0xFF)		//Byte already erased, skip the (slow) EEPROM write cycle
+							continue;			//(continue jumps to the while() test, so i still gets incremented)
+						#endif
+						EEDATA = 0xFF;
+						EECON1 = 0b00000100;	//EEPROM Write mode
+						mUSBDriverServicePoll(); 	//Call USBDriverService() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
+						UnlockAndActivate();					
+					}while(i++<((EEPROMSize-1)+(EEPROMEffectiveAddress & (EEPROMSize-1))));
+				}
+				#endif
+
+				//Now erase the User ID space (0x200000 to 0x200007)
+				if(EraseFlags & EraseRangeUserID)
+				{
+					TBLPTR = UserIDAddress;
+					#if defined(USE_LAZY_ERASE)
+					mMarkRowErased(LazyEraseUserIDRow);
+					#endif
+					#if defined(USE_BLANK_CHECK_ERASE)
+					if(!IsFlashBlank(UserIDSize))
+					#endif
+					{
+						TBLPTR = UserIDAddress;
+						EECON1 = 0b10010100;	//Prepare for erasing flash memory
+						UnlockAndActivate();
+					}
+				}
+				#endif //USE_BACKGROUND_ERASE
+
+				#if defined(USE_ERASE_RANGE_COMMAND)
+				if(PacketFromPC.Command == ERASE_RANGE)
+				{
+					PacketToPC.Command = ERASE_RANGE;
+					PacketToPC.Address = PacketFromPC.Address;
+					PacketToPC.Length = PacketFromPC.Length;
+					PacketToPC.RangeFlags = PacketFromPC.RangeFlags;
+					PacketToPC.ErasedPages = ErasedPageCount;
+					BootTxPacket((char *)&PacketToPC, 64);
+				}
+				#endif
+				BootState = Idle;				
+			}
+				break;
+			case PROGRAM_DEVICE:
+			{
+				//Check if host is trying to program the config bits
+				if(PacketFromPC.Contents[3] == 0x30) // 			//PacketFromPC.Contents[3] is bits 23:16 of the address.  
+				{													//0x30 implies config bits
+					if(ConfigsLockValue == FALSE)
+					{
+						WriteConfigBits();		//Doesn't get reprogrammed if the UNLOCK_CONFIG (LockValue = UNLOCKCONFIG) command hasn't previously been sent
+					}
+					BootState = Idle;
+					break;
+				}
+
+				#if defined(DEVICE_WITH_EEPROM)
+				//Check if host is trying to program the EEPROM
+				if(PacketFromPC.Contents[3] == 0xF0)	//PacketFromPC.Contents[3] is bits 23:16 of the address.  
+				{										//0xF0 implies EEPROM
+					WriteEEPROM();
+					BootState = Idle;
+					break;
+				}
+				#endif
+
+				#if defined(USE_AUTO_SECTION_PROGRAMMING)
+				SeekProgrammedPointer();	//Handles address jumps, so the check below always passes
+				#endif
+				if(ProgrammedPointer == (UINT24)InvalidAddress)
+					ProgrammedPointer = PacketFromPC.Address;
+				
+				if(ProgrammedPointer == (UINT24)PacketFromPC.Address)
+				{
+					for(i = 0; i < PacketFromPC.Size; i++)
+					{
+						ProgrammingBuffer[BufferedDataIndex] = PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)];	//Data field is right justified.  Need to put it in the buffer left justified.
+						BufferedDataIndex++;
+						ProgrammedPointer++;
+						if(BufferedDataIndex == ProgramBlockSize)
+						{
+							WriteFlashBlock();
+						}
+					}
+				}
+				//else host sent us a non-contiguous packet address...  to make this firmware simpler, host should not do this without sending a PROGRAM_COMPLETE command in between program sections.
+				//(unless USE_AUTO_SECTION_PROGRAMMING is enabled, in which case SeekProgrammedPointer() has already taken care of it)
+				BootState = Idle;
+			}
+				break;
+			#if defined(USE_COMPRESSED_PROGRAMMING)
+			case PROGRAM_COMPRESSED:
+			{
+				//Only program memory (and the User ID) may be sent compressed.  Config bits and EEPROM always use PROGRAM_DEVICE,
+				//and packets addressed anywhere else (in particular, into the bootloader itself) are dropped, like FILL requests.
+				if(WritableRangeEnd() == 0)
+				{
+					BootState = Idle;
+					break;
+				}
+				#if defined(USE_AUTO_SECTION_PROGRAMMING)
+				SeekProgrammedPointer();	//Handles address jumps, so the check below always passes
+				#endif
+				if(ProgrammedPointer == (UINT24)InvalidAddress)
+					ProgrammedPointer = PacketFromPC.Address;
+
+				if(ProgrammedPointer == (UINT24)PacketFromPC.Address)
+				{
+					ExpandCompressedPacket();
+				}
+				//else non-contiguous, same rules as PROGRAM_DEVICE
+				BootState = Idle;
+			}
+				break;
+			#endif
+			#if defined(USE_FILL_COMMAND)
+			case FILL:
+			{
+				//Never write outside of the program memory and User ID ranges reported by QUERY_DEVICE (in particular, not
+				//into the bootloader itself).  Requests that don't fit are dropped, like a non-contiguous PROGRAM_DEVICE packet.
+				if(IsFillInRange() == FALSE)
+				{
+					BootState = Idle;
+					break;
+				}
+				//Same contiguous section rules as PROGRAM_DEVICE, so FILL and PROGRAM_DEVICE packets can be freely mixed within a section
+				#if defined(USE_AUTO_SECTION_PROGRAMMING)
+				SeekProgrammedPointer();	//Handles address jumps, so the check below always passes
+				#endif
+				if(ProgrammedPointer == (UINT24)InvalidAddress)
+					ProgrammedPointer = PacketFromPC.Address;
+
+				if(ProgrammedPointer == (UINT24)PacketFromPC.Address)
+				{
+					//At most one block per pass, so a long run doesn't keep the main loop from servicing USB for seconds.
+					//PacketFromPC.Address and PacketFromPC.Length double as the fill state, the same way READ_STREAM uses
+					//them, and we stay NotIdle (so no new command is accepted) until the run is done.
+					while(PacketFromPC.Length)
+					{
+						BufferProgramByte(PacketFromPC.FillValue);
+						PacketFromPC.Address++;
+						PacketFromPC.Length--;
+						if(BufferedDataIndex == 0)
+							break;		//A block has just been written
+					}
+					if(PacketFromPC.Length)
+						break;
+				}
+				BootState = Idle;
+			}
+				break;
+			#endif
+			#if defined(USE_PATCH_COMMAND)
+			case PATCH_DEVICE:
+			{
+				//Never erase anything outside of the application space (in particular, not the bootloader itself)
+				if(((UINT24)PacketFromPC.Address >= ProgramMemStart) && (((UINT24)PacketFromPC.Address + PacketFromPC.Size) <= ProgramMemStop))
+				{
+					//The ProgrammingBuffer gets reused as the row buffer, so finish off any PROGRAM_DEVICE section first.
+					while(BufferedDataIndex != 0)
+					{
+						WriteFlashBlock();
+					}
+					PatchFlashRows();
+					ProgrammedPointer = InvalidAddress;		//Next PROGRAM_DEVICE starts a new section
+				}
+				BootState = Idle;
+			}
+				break;
+			#endif
+			case PROGRAM_COMPLETE:
+			{
+				WriteFlashBlock();
+				#if defined(USE_LAZY_ERASE) && defined(LAZY_ERASE_UNTOUCHED_ROWS)
+				//Don't leave pieces of the previous application behind.  The rows erased here are marked in the RowErasedMap,
+				//so if a later section of the image does land in one of them, it doesn't get erased a second time.
+				for(ErasePageTracker = StartPageToErase; ErasePageTracker <= MaxPageToErase; ErasePageTracker++)
+				{
+					ClrWdt();
+					TBLPTR = ((UINT24)ErasePageTracker << 6);
+					LazyEraseRow();
+					mUSBDriverServicePoll(); 	//Call USBDriverService() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
+				}
+				#endif
+				ProgrammedPointer = InvalidAddress;		//Reinitialize pointer to an invalid range, so we know the next PROGRAM_DEVICE will be the start address of a contiguous section.
+				BootState = Idle;
+			}
+				break;
+			case GET_DATA:
+			{
+				//Init pad bytes to 0x00...  Already done after we received the QUERY_DEVICE command (just after calling BootRxPacket()).
+				PacketToPC.Command = GET_DATA;
+				PacketToPC.Address = PacketFromPC.Address;
+				PacketToPC.Size = PacketFromPC.Size;
+				ReadMemoryToPacket();
+
+				if(!mBootTxIsBusy())
+				{
+					BootTxPacket((char *)&PacketToPC, 64);
+					BootState = Idle;
+				}
+			}
+				break;
+			case RESET_DEVICE:
+			{
+				UCONbits.SUSPND = 0;		//Disable USB module
+				UCON = 0x00;				//Disable USB module
+				//And wait awhile for the USB cable capacitance to discharge down to disconnected (SE0) state. 
+				//Otherwise host might not realize we disconnected/reconnected when we do the reset.
+				//A basic for() loop decrementing a 16 bit number would be simpler, but seems to take more code space for
+				//a given delay.  So do this instead:
+				for(i = 0; i < 0xFF; i++)
+				{
+					WREG = 0xFF;
+					while(WREG)
+					{
+						WREG--;
+						#if defined(__18CXX)
+						_asm
+						bra	0	//Equivalent to bra $+2, which takes half as much code as 2 nop instructions
+						bra	0	//Equivalent to bra $+2, which takes half as much code as 2 nop instructions
+						_endasm
+						#else
+						pic18_delay_cycles(9);	//Host build: about what one pass of this loop takes on the part, for the timing model
+						#endif
+					}
+				}
+				Reset();
+			}
+				break;
+			#if defined(USE_READ_STREAM_COMMAND)
+			case READ_STREAM:
+			{
+				//PacketFromPC.Address and PacketFromPC.Length double as the stream state.  They get advanced each
+				//time a packet goes out, and we stay NotIdle (so no new command is accepted) until the range is done.
+				if(!mBootTxIsBusy())
+				{
+					PacketToPC.Command = READ_STREAM;
+					PacketToPC.Address = PacketFromPC.Address;
+					PacketToPC.Size = RequestDataBlockSize;
+					if(PacketFromPC.Length < RequestDataBlockSize)
+						PacketToPC.Size = (unsigned char)PacketFromPC.Length;
+					ReadMemoryToPacket();
+					PacketFromPC.Address += PacketToPC.Size;
+					PacketFromPC.Length -= PacketToPC.Size;
+					BootTxPacket((char *)&PacketToPC, 64);	//(With ping-pong and zero copy, PacketToPC moves to the other IN buffer after this)
+
+					if(PacketFromPC.Length == 0)
+						BootState = Idle;
+				}
+			}
+				break;
+			#endif
+			#if defined(USE_BACKGROUND_ERASE)
+			case GET_ERASE_STATUS:
+			{
+				if(!mBootTxIsBusy())
+				{
+					PacketToPC.Command = GET_ERASE_STATUS;
+					if(EraseState != EraseIdle)
+						PacketToPC.StatusFlags = StatusEraseBusy;
+					PacketToPC.ErasePagesDone = ErasePageTracker - EraseStartPage;
+					if(EraseState == EraseFlashRows)
+						PacketToPC.ErasePagesRemaining = EraseStopPage - ErasePageTracker;
+					PacketToPC.ErasedPageTotal = ErasedPageCount;
+					BootTxPacket((char *)&PacketToPC, 64);
+					BootState = Idle;
+				}
+			}
+				break;
+			#endif
+			#if defined(USE_VERIFY_RANGE_COMMAND)
+			case VERIFY_RANGE:
+			{
+				if(!mBootTxIsBusy())
+				{
+					PacketToPC.Command = VERIFY_RANGE;
+					PacketToPC.Address = PacketFromPC.Address;
+					PacketToPC.Length = PacketFromPC.Length;
+					PacketToPC.Checksum = CalculateRangeCRC();
+					BootTxPacket((char *)&PacketToPC, 64);
+					BootState = Idle;
+				}
+			}
+				break;
+			#endif
+		}//End switch
+
+		#if defined(USE_ZERO_COPY_PACKETS)
+		if(BootState == Idle)
+			BootRxRelease();		//Done with the command, so the SIE can have its buffer back for the next one
+		#endif
+	}//End if(BootState == NotIdle)
+
+}//End ProcessIO()
+
+
+void WriteFlashBlock(void)		//Use to write blocks of data to flash.
+{
+    static unsigned char i;
+	static unsigned char BytesTakenFromBuffer;
+	static unsigned char CorrectionFactor;
+
+    BytesTakenFromBuffer = 0;
+	TBLPTR = (ProgrammedPointer - BufferedDataIndex);
+
+	//Check the lower 5 bits of the TBLPTR to verify it is pointing to a 32 byte aligned block (5 LSb = 00000).
+	//If it isn't, need to somehow make it so before doing the actual loading of the programming latches.
+	//In order to maximize programming speed, the PC application meant to be used with this firmware will not send 
+	//large blocks of 0xFF bytes.  If the PC application
+	//detects a large block of unprogrammed space in the hex file (effectively = 0xFF), it will skip over that
+	//section and will not send it to the firmware.  This works, because the firmware will have already done an
+	//erase on that section of memory when it received the ERASE_DEVICE command from the PC.  Therefore, the section
+	//can be left unprogrammed (after an erase the flash ends up = 0xFF).
+	//This can result in a problem however, in that the next genuine non-0xFF section in the hex file may not start 
+	//on a 32 byte aligned block boundary.  This needs to be handled with care since the microcontroller can only 
+	//program 32 byte blocks that are aligned with 32 byte boundaries.
+	//So, use the below code to avoid this potential issue.
+
+	#if(ProgramBlockSize == 0x20)
+		CorrectionFactor = (TBLPTRL & 0b00011111);	//Correctionfactor = number of bytes tblptr must go back to find the immediate preceeding 32 byte boundary
+		TBLPTRL &= 0b11100000;						//Move the table pointer back to the immediately preceeding 32 byte boundary
+	#elif(ProgramBlockSize == 0x10)
+		CorrectionFactor = (TBLPTRL & 0b00001111);	//Correctionfactor = number of bytes tblptr must go back to find the immediate preceeding 16 byte boundary
+		TBLPTRL &= 0b11110000;						//Move the table pointer back to the immediately preceeding 16 byte boundary
+	#elif(ProgramBlockSize == 0x8)
+		CorrectionFactor = (TBLPTRL & 0b00000111);	//Correctionfactor = number of bytes tblptr must go back to find the immediate preceeding 16 byte boundary
+		TBLPTRL &= 0b11111000;						//Move the table pointer back to the immediately preceeding 16 byte boundary
+	#else
+		#error Double click this error message and fix this section for your microcontroller type.
+	#endif
+
+	#if defined(USE_LAZY_ERASE)
+	//The host doesn't have to send ERASE_DEVICE first, so make sure the row is erased before the first block goes into it.
+	//(Nothing to do for an empty buffer: the block is all 0xFF then, and programming 0xFF doesn't change any flash bits.)
+	if(BufferedDataIndex != 0)
+		LazyEraseRow();
+	#endif
+
+	for(i = 0; i < ProgramBlockSize; i++)	//Load the programming latches
+	{
+		if(CorrectionFactor == 0)
+		{
+			if(BufferedDataIndex != 0)	//If the buffer isn't empty
+			{
+				TABLAT = ProgrammingBuffer[BytesTakenFromBuffer];
+				TblWtPostInc();
+				BytesTakenFromBuffer++;
+				BufferedDataIndex--;	//Used up a byte from the buffer.
+			}
+			else	//No more data in buffer, need to write 0xFF to fill the rest of the programming latch locations
+			{
+				TABLAT = 0xFF;
+				TblWtPostInc();				
+			}
+		}
+		else
+		{
+			TABLAT = 0xFF;
+			TblWtPostInc();
+			CorrectionFactor--;
+		}
+	}
+
+//	TBLPTR--;		//Need to make table pointer point to the region which will be programmed before initiating the programming operation
+	TblRdPostDec();	//Do this instead of TBLPTR--; since it takes less code space.
+		
+	EECON1 = 0b10100100;	//flash programming mode
+	UnlockAndActivate();
+
+	//Now need to fix the ProgrammingBuffer[].  We may not have taken a full 32 bytes out of the buffer.  In this case,
+	//the data is no longer justified correctly.
+	for(i = 0; i < BufferedDataIndex; i++)	//Need to rejustify the remaining data to the "left" of the buffer (if there is any left)
+	{
+		ProgrammingBuffer[i] = ProgrammingBuffer[BytesTakenFromBuffer+i];
+	}
+}
+
+
+void ReadMemoryToPacket(void)	//Reads PacketToPC.Size bytes starting at PacketToPC.Address into PacketToPC.Data (right justified)
+{
+	static unsigned char i;
+
+	TBLPTR = (UINT24)PacketToPC.Address;
+	#if defined(DEVICE_WITH_EEPROM)
+	EEADR = (unsigned char)PacketToPC.Address;	//The bits 7:0 are 1:1 mapped to the EEPROM address space values
+	#endif
+	for(i = 0; i < PacketToPC.Size; i++)
+	{
+		PacketToPC.Data[i+((TotalPacketSize - 6) - PacketToPC.Size)] = ReadNextByte();
+	}
+}
+
+#if defined(USE_BLANK_CHECK_ERASE)
+BOOL IsFlashBlank(unsigned char Length)	//Table reads Length bytes starting at TBLPTR, and returns TRUE if they are all 0xFF (erased)
+{
+	while(Length)
+	{
+		TblRdPostInc();
+		if(TABLAT != 0xFF)
+			return FALSE;
+		Length--;
+	}
+	return TRUE;
+}
+#endif
+
+unsigned char ReadNextByte(void)	//Returns the byte at TBLPTR (or at EEADR, if PacketFromPC.Address is an EEPROM address) and advances to the next address
+{
+	if(PacketFromPC.Contents[3] == 0xF0)	//PacketFromPC.Contents[3] is bits 23:16 of the address.  
+	{										//0xF0 implies EEPROM, which doesn't use the table pointer to read from
+		#if defined(DEVICE_WITH_EEPROM)
+		EECON1 = 0b00000000;	//EEPROM read mode
+		EECON1bits.RD = 1;
+		EEADR++;
+		return EEDATA;
+		#else
+		return 0x00;
+		#endif
+	}
+
+	//else must have been a normal program memory region, or one that can be read from with the table pointer
+	TblRdPostInc();
+
+    //since 0x300004 and 0x300007 are not implemented we need to return 0xFF
+    //  since the device reads 0x00 but the hex file has 0x00
+    if(TBLPTRU == 0x30)
+    {
+        if(TBLPTRL == 0x05)
+            TABLAT = 0xFF;
+        if(TBLPTRL == 0x08)
+            TABLAT = 0xFF;
+    }
+	return TABLAT;
+}
+
+#if defined(USE_VERIFY_RANGE_COMMAND)
+unsigned int CalculateRangeCRC(void)	//CRC-16 of the PacketFromPC.Length bytes starting at PacketFromPC.Address.  Reads the same data GET_DATA would return.
+{
+	static unsigned int crc;
+	static unsigned char x;
+
+	crc = VerifyCRCInitialValue;
+	TBLPTR = (UINT24)PacketFromPC.Address;
+	#if defined(DEVICE_WITH_EEPROM)
+	EEADR = (unsigned char)PacketFromPC.Address;
+	#endif
+	while(PacketFromPC.Length)
+	{
+		//Byte at a time CRC-16/CCITT, without a lookup table (the table would cost 512 bytes of code space)
+		x = ReadNextByte() ^ (unsigned char)(crc >> 8);
+		x ^= x >> 4;
+		crc = (crc << 8) ^ ((unsigned int)x << 12) ^ ((unsigned int)x << 5) ^ x;
+
+		PacketFromPC.Length--;
+		if(((unsigned char)PacketFromPC.Length & 0x3F) == 0)
+			mUSBDriverServicePoll(); 	//Call USBDriverService() periodically to prevent falling off the bus if any SETUP packets should happen to arrive.
+	}
+	return crc;
+}
+#endif
+
+
+#if defined(USE_COMPRESSED_PROGRAMMING) || defined(USE_FILL_COMMAND)
+void BufferProgramByte(unsigned char Value)	//Appends one byte to the ProgrammingBuffer, and writes the block to flash once it is full
+{
+	ProgrammingBuffer[BufferedDataIndex] = Value;
+	BufferedDataIndex++;
+	ProgrammedPointer++;
+	if(BufferedDataIndex == ProgramBlockSize)
+	{
+		WriteFlashBlock();
+		mUSBDriverServicePoll(); 	//One packet can expand to many blocks, so keep servicing the bus (same as the erase loop does)
+	}
+}
+#endif
+
+#if defined(USE_COMPRESSED_PROGRAMMING) || defined(USE_FILL_COMMAND)
+UINT24 WritableRangeEnd(void)	//End of the program memory or User ID range that PacketFromPC.Address lies in, 0 if neither
+{
+	if((PacketFromPC.Address >= ProgramMemStart) && (PacketFromPC.Address < ProgramMemStop))
+		return ProgramMemStop;
+	if((PacketFromPC.Address >= UserIDAddress) && (PacketFromPC.Address < (UserIDAddress + UserIDSize)))
+		return UserIDAddress + UserIDSize;
+	return 0;
+}
+#endif
+
+#if defined(USE_FILL_COMMAND)
+BOOL IsFillInRange(void)	//TRUE if the FILL request's Address to Address + Length lies within program memory or the User ID
+{
+	static UINT24 End;
+
+	//Length is checked against the room left after Address, so Address + Length can't wrap around
+	End = WritableRangeEnd();
+	if(End == 0)
+		return FALSE;
+	return (PacketFromPC.Length <= (End - PacketFromPC.Address));
+}
+#endif
+
+#if defined(USE_AUTO_SECTION_PROGRAMMING)
+//Moves ProgrammedPointer to PacketFromPC.Address.  If the new address is further on inside the programming block
+//currently being assembled, the gap is padded with 0xFF and the data gets merged into the same block write.  Otherwise
+//whatever is buffered gets flushed first, exactly as PROGRAM_COMPLETE would, and a new section starts at the new address.
+void SeekProgrammedPointer(void)
+{
+	static UINT24 BlockEnd;
+
+	if(ProgrammedPointer == (UINT24)InvalidAddress)
+	{
+		ProgrammedPointer = PacketFromPC.Address;
+		return;
+	}
+
+	BlockEnd = ((ProgrammedPointer - BufferedDataIndex) | (ProgramBlockSize - 1)) + 1;	//End of the block the buffered data starts in
+	if(((UINT24)PacketFromPC.Address > ProgrammedPointer) && ((UINT24)PacketFromPC.Address < BlockEnd))
+	{
+		while(ProgrammedPointer != (UINT24)PacketFromPC.Address)	//Can't fill the buffer, since the address is still inside the same block
+		{
+			ProgrammingBuffer[BufferedDataIndex] = 0xFF;
+			BufferedDataIndex++;
+			ProgrammedPointer++;
+		}
+	}
+	else if(ProgrammedPointer != (UINT24)PacketFromPC.Address)
+	{
+		while(BufferedDataIndex != 0)	//An unaligned start can leave data for one more block after the first WriteFlashBlock()
+		{
+			WriteFlashBlock();
+		}
+		ProgrammedPointer = PacketFromPC.Address;
+	}
+}
+#endif
+
+#if defined(USE_PATCH_COMMAND)
+//Merges the PATCH_DEVICE packet data into flash one 64 byte erase row at a time: the row is read into the
+//ProgrammingBuffer, the new bytes are copied over it, and then the row is erased and written back.  Rows that
+//would end up unchanged are left alone.
+void PatchFlashRows(void)
+{
+	static unsigned char i;
+	static unsigned char Offset;
+	static UINT24 RowAddress;
+	static BOOL RowChanged;
+
+	i = 0;
+	while(i < PacketFromPC.Size)
+	{
+		RowAddress = ((UINT24)PacketFromPC.Address + i) & 0xFFFFC0;
+
+		TBLPTR = RowAddress;
+		for(Offset = 0; Offset < BufferSize; Offset++)
+		{
+			ProgrammingBuffer[Offset] = ReadNextByte();
+		}
+
+		RowChanged = FALSE;
+		Offset = ((unsigned char)PacketFromPC.Address + i) & 0x3F;
+		do
+		{
+			if(ProgrammingBuffer[Offset] != PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)])	//Data field is right justified
+			{
+				ProgrammingBuffer[Offset] = PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)];
+				RowChanged = TRUE;
+			}
+			i++;
+			Offset++;
+		}while((i < PacketFromPC.Size) && (Offset < BufferSize));
+
+		if(RowChanged == TRUE)
+		{
+			ClrWdt();
+			TBLPTR = RowAddress;
+			EECON1 = 0b10010100;	//Prepare for erasing flash memory
+			UnlockAndActivate();
+			#if defined(USE_LAZY_ERASE)
+			mMarkRowErased((unsigned int)(RowAddress >> 6));	//Just erased, so WriteFlashBlock() must not erase it again before writing it back
+			#endif
+
+			ProgrammedPointer = RowAddress + BufferSize;	//WriteFlashBlock() programs from (ProgrammedPointer - BufferedDataIndex)
+			BufferedDataIndex = BufferSize;
+			while(BufferedDataIndex != 0)
+			{
+				WriteFlashBlock();
+			}
+			#if defined(USE_LAZY_ERASE)
+			mClearRowErased((unsigned int)(RowAddress >> 6));	//The row holds data again, so a later PROGRAM_DEVICE into it has to erase it first
+			#endif
+			mUSBDriverServicePoll(); 	//A packet can span two rows, so keep servicing the bus (same as the erase loop does)
+		}
+	}
+}
+#endif
+
+#if defined(USE_COMPRESSED_PROGRAMMING)
+//PROGRAM_COMPRESSED payload format (PackBits).  Each run starts with a header byte n:
+//	n = 0x00-0x7F: the next n+1 bytes are copied as-is
+//	n = 0x81-0xFF: the next byte is repeated 257-n times (2 to 128 times)
+//	n = 0x80:      no operation
+//Runs must not straddle packets: each packet's payload is a complete stream by itself.
+//Expansion stops at the end of the range (program memory or User ID) the packet starts in, whatever the runs say.
+void ExpandCompressedPacket(void)
+{
+	static unsigned char i;
+	static unsigned char Count;
+	static unsigned char Value;
+	static UINT24 Stop;
+
+	Stop = WritableRangeEnd();		//PacketFromPC.Address == ProgrammedPointer here
+	i = RequestDataBlockSize - PacketFromPC.Size;	//Data field is right justified
+	while(i < RequestDataBlockSize)
+	{
+		Count = PacketFromPC.Data[i++];
+		if(Count < 0x80)	//Literal run
+		{
+			Count++;
+			while(Count && (i < RequestDataBlockSize))
+			{
+				if(ProgrammedPointer >= Stop)
+					return;
+				BufferProgramByte(PacketFromPC.Data[i++]);
+				Count--;
+			}
+		}
+		else if((Count != 0x80) && (i < RequestDataBlockSize))	//Repeat run
+		{
+			Value = PacketFromPC.Data[i++];
+			Count = 1 - Count;		//257 - n, in 8 bit arithmetic
+			do{
+				if(ProgrammedPointer >= Stop)
+					return;
+				BufferProgramByte(Value);
+			}while(--Count);
+		}
+	}
+}
+#endif
+
+#if defined(USE_BACKGROUND_ERASE)
+void EraseNextUnit(void)	//Carries out the next step of the erase started by ERASE_DEVICE/ERASE_RANGE: one flash row, one EEPROM byte, or the User ID
+{
+	ClrWdt();
+	if(EraseState == EraseFlashRows)
+	{
+		if(ErasePageTracker < EraseStopPage)
+		{
+			TBLPTR = ((UINT24)ErasePageTracker << 6);
+			#if defined(USE_LAZY_ERASE)
+			mMarkRowErased(ErasePageTracker);
+			#endif
+			ErasePageTracker++;
+			#if defined(USE_BLANK_CHECK_ERASE)
+			if(IsFlashBlank(64))	//Already erased?  Then don't spend the time (and the endurance) erasing it again.
+				return;
+			TBLPTR = ((UINT24)(ErasePageTracker - 1) << 6);
+			#endif
+			EECON1 = 0b10010100;	//Prepare for erasing flash memory
+			UnlockAndActivate();
+			ErasedPageCount++;
+			return;
+		}
+		EraseState = EraseEEPROMBytes;
+	}
+
+	#if defined(DEVICE_WITH_EEPROM)
+	if(EraseState == EraseEEPROMBytes)
+	{
+		if(EraseFlags & EraseRangeEEPROM)
+		{
+			EEADR = EraseEEPROMIndex++;
+			if(EraseEEPROMIndex == (unsigned char)(EEPROMSize + (EEPROMEffectiveAddress & (EEPROMSize-1))))
+				EraseState = EraseUserIDSpace;	//This is the last byte
+			#if defined(USE_BLANK_CHECK_ERASE)
+			EECON1 = 0b00000000;	//EEPROM read mode
+			EECON1bits.RD = 1;
+			if(EEDATA == 0xFF)		//Byte already erased, skip the (slow) EEPROM write cycle
+				return;
+			#endif
+			EEDATA = 0xFF;
+			EECON1 = 0b00000100;	//EEPROM Write mode
+			UnlockAndActivate();
+			return;
+		}
+	}
+	#endif
+
+	//Last step: the User ID space (0x200000 to 0x200007)
+	if(EraseFlags & EraseRangeUserID)
+	{
+		TBLPTR = UserIDAddress;
+		#if defined(USE_LAZY_ERASE)
+		mMarkRowErased(LazyEraseUserIDRow);
+		#endif
+		#if defined(USE_BLANK_CHECK_ERASE)
+		if(!IsFlashBlank(UserIDSize))
+		#endif
+		{
+			TBLPTR = UserIDAddress;
+			EECON1 = 0b10010100;	//Prepare for erasing flash memory
+			UnlockAndActivate();
+		}
+	}
+	EraseState = EraseIdle;
+}
+#endif
+
+#if defined(USE_LAZY_ERASE)
+void LazyEraseRow(void)		//Erases the 64 byte row TBLPTR points into, unless it has already been erased since the bootloader started.  TBLPTR is left unchanged.
+{
+	static UINT24 Address;
+	static unsigned int Page;
+
+	Address = TBLPTR;
+	Page = (unsigned int)(Address >> 6);
+	if(Address >= UserIDAddress)
+		Page = LazyEraseUserIDRow;
+	else if((Page < StartPageToErase) || (Page > MaxPageToErase))
+		return;				//Never erase the bootloader itself
+
+	if(mRowErasedByte(Page) & mRowErasedBit(Page))
+		return;
+	mMarkRowErased(Page);
+
+	TBLPTRL &= 0b11000000;	//Erase works on the whole row
+	EECON1 = 0b10010100;	//Prepare for erasing flash memory
+	UnlockAndActivate();
+	TBLPTR = Address;
+}
+#endif
+
+void WriteConfigBits(void)	//Also used to write the Device ID
+{
+	static unsigned char i;
+
+	TBLPTR = (UINT24)PacketFromPC.Address;
+
+	for(i = 0; i < PacketFromPC.Size; i++)
+	{
+		TABLAT = PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)];
+		TblWt();
+
+		EECON1 = 0b11000100;	//Config bits programming mode
+		UnlockAndActivate();
+
+		TblRdPostInc();
+	}
+}
+
+#if defined(DEVICE_WITH_EEPROM)
+void WriteEEPROM(void)
+{
+	static unsigned char i;
+	
+	for(i = 0; i < PacketFromPC.Size; i++)
+	{
+		EEADR = (((unsigned char)PacketFromPC.Address) + i);
+		EEDATA = PacketFromPC.Data[i+(RequestDataBlockSize-PacketFromPC.Size)];
+
+		EECON1 = 0b00000100;	//EEPROM Write mode
+		UnlockAndActivate();
+	}
+
+}
+#endif
+
+void UnlockAndActivate(void)
+{
+	#if defined(USB_INTERRUPT)
+	unsigned char GIESave;
+
+	GIESave = INTCON & 0x80;	//Remember if the USB interrupt was on, it must not fire inside the unlock sequence
+	#endif
+	INTCONbits.GIE = 0;		//Make certain interrupts disabled for unlock process.
+	#if defined(__18CXX)
+	_asm
+	//Now unlock sequence to set WR (make sure interrupts are disabled before executing this)
+	MOVLW 0x55
+	MOVWF EECON2, 0
+	MOVLW 0xAA
+	MOVWF EECON2, 0
+	BSF EECON1, 1, 0		//Performs write
+	_endasm	
+	#else
+	EECON2 = 0x55;
+	EECON2 = 0xAA;
+	EECON1bits.WR = 1;
+	pic18_activate_write();	//Host build: the model can't see register writes, so it is told when WR gets set
+	#endif
+	#if defined(USB_INTERRUPT)
+	INTCON |= GIESave;		//Flash stalls the CPU until done anyway, but an EEPROM write doesn't: let USB be serviced while waiting
+	#endif
+	while(EECON1bits.WR);	//Wait until complete (relevant when programming EEPROM, not important when programming flash since processor stalls during flash program)	
+	EECON1bits.WREN = 0;  	//Good practice now to clear the WREN bit, as further protection against any accidental activation of self write/erase operations.
+}	
+
+
+#if defined(USE_SERIAL_NUMBER_STRING)
+void BuildSerialNumberString(void)	//Fills in sd003 (usbdsc.c) with the User ID bytes as hex digits, in address order
+{
+	unsigned char i;
+	unsigned char Nibble;
+
+	sd003.bLength = sizeof(sd003);
+	sd003.bDscType = DSC_STR;
+	TBLPTR = UserIDAddress;
+	for(i = 0; i < UserIDSize * 2; i++)
+	{
+		if((i & 1) == 0)
+		{
+			TblRdPostInc();
+			Nibble = TABLAT >> 4;
+		}
+		else
+			Nibble = TABLAT & 0x0F;
+		sd003.string[i] = (Nibble < 10) ? ('0' + Nibble) : ('A' - 10 + Nibble);
+	}
+}
+#endif
+
+/** EOF Boot4450Family.c *********************************************************/
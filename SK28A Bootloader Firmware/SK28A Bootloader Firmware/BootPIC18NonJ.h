@@ -1,48 +1,48 @@
-/*********************************************************************
- *
- *   Microchip USB HID Bootloader v1.0 for PIC18F and PIC18LF versions of:
- *	 PIC18F4553/4458/2553/2458
- *	 PIC18F4550/4455/2550/2455
- *	 PIC18F4450/2450
- *	 PIC18F14K50/13K50
- *
- *********************************************************************
- * FileName:        BootPIC18NonJ.h
- * Dependencies:    See INCLUDES section below
- * Processor:       PIC18
- * Compiler:        C18 2.30.01+
- * Company:         Microchip Technology, Inc.
- *
- * Software License Agreement
- *
- * The software supplied herewith by Microchip Technology Incorporated
- * (the Company) for its PICmicro Microcontroller is intended and
- * supplied to you, the Companys customer, for use solely and
- * exclusively on Microchip PICmicro Microcontroller products. The
- * software is owned by the Company and/or its supplier, and is
- * protected under applicable copyright laws. All rights are reserved.
- * Any use in violation of the foregoing restrictions may subject the
- * user to criminal sanctions under applicable laws, as well as to
- * civil liability for the breach of the terms and conditions of this
- * license.
- *
- * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
- * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
- * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
- * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
- * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
- * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
- *
- * File version         Date        Comment
- *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
- * 1.0					06/03/2008	Original
- ********************************************************************/
-#ifndef BOOTPIC18NONJ_H
-#define BOOTPIC18NONJ_H
-
-/** P U B L I C  P R O T O T Y P E S *****************************************/
-void UserInit(void);
-void ProcessIO(void);
-
-
-#endif //BOOTPIC18NONJ_H
+/*********************************************************************
+ *
+ *   Microchip USB HID Bootloader v1.0 for PIC18F and PIC18LF versions of:
+ *	 PIC18F4553/4458/2553/2458
+ *	 PIC18F4550/4455/2550/2455
+ *	 PIC18F4450/2450
+ *	 PIC18F14K50/13K50
+ *
+ *********************************************************************
+ * FileName:        BootPIC18NonJ.h
+ * Dependencies:    See INCLUDES section below
+ * Processor:       PIC18
+ * Compiler:        C18 2.30.01+
+ * Company:         Microchip Technology, Inc.
+ *
+ * Software License Agreement
+ *
+ * The software supplied herewith by Microchip Technology Incorporated
+ * (the Company) for its PICmicro® Microcontroller is intended and
+ * supplied to you, the Companys customer, for use solely and
+ * exclusively on Microchip PICmicro Microcontroller products. The
+ * software is owned by the Company and/or its supplier, and is
+ * protected under applicable copyright laws. All rights are reserved.
+ * Any use in violation of the foregoing restrictions may subject the
+ * user to criminal sanctions under applicable laws, as well as to
+ * civil liability for the breach of the terms and conditions of this
+ * license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * File version         Date        Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * 1.0					06/03/2008	Original
+ ********************************************************************/
+#ifndef BOOTPIC18NONJ_H
+#define BOOTPIC18NONJ_H
+
+/** P U B L I C  P R O T O T Y P E S *****************************************/
+void UserInit(void);
+void ProcessIO(void);
+
+
+#endif //BOOTPIC18NONJ_H
@@ -1,62 +1,66 @@
-/*********************************************************************
- *
- *                Microchip USB C18 Firmware Version 1.0
- *
- *********************************************************************
- * FileName:        usb.h
- * Dependencies:    See INCLUDES section below
- * Processor:       PIC18
- * Compiler:        C18 2.30.01+
- * Company:         Microchip Technology, Inc.
- *
- * Software License Agreement
- *
- * The software supplied herewith by Microchip Technology Incorporated
- * (the Company) for its PICmicro Microcontroller is intended and
- * supplied to you, the Companys customer, for use solely and
- * exclusively on Microchip PICmicro Microcontroller products. The
- * software is owned by the Company and/or its supplier, and is
- * protected under applicable copyright laws. All rights are reserved.
- * Any use in violation of the foregoing restrictions may subject the
- * user to criminal sanctions under applicable laws, as well as to
- * civil liability for the breach of the terms and conditions of this
- * license.
- *
- * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
- * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
- * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
- * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
- * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
- * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
- *
- * Author               Date        Comment
- *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
- * Rawin Rojvanit       11/19/04    Original.
- ********************************************************************/
-#ifndef USB_H
-#define USB_H
-
-/*
- * usb.h provides a centralize way to include all files
- * required by Microchip USB Firmware.
- *
- * The order of inclusion is important.
- * Dependency conflicts are resolved by the correct ordering.
- */
-
-#include "usbcfg.h"
-#include "usbdefs_std_dsc.h"
-#include "usbdsc.h"
-
-#include "usbdefs_ep0_buff.h"
-#include "usbmmap.h"
-
-#include "usbdrv.h"
-#include "usbctrltrf.h"
-#include "usb9.h"
-
-#if defined(USB_USE_HID)                // See autofiles\usbcfg.h
-#include "hid.h"
-#endif
-
-#endif //USB_H
+/*********************************************************************
+ *
+ *                Microchip USB C18 Firmware Version 1.0
+ *
+ *********************************************************************
+ * FileName:        usb.h
+ * Dependencies:    See INCLUDES section below
+ * Processor:       PIC18
+ * Compiler:        C18 2.30.01+
+ * Company:         Microchip Technology, Inc.
+ *
+ * Software License Agreement
+ *
+ * The software supplied herewith by Microchip Technology Incorporated
+ * (the Company) for its PICmicro® Microcontroller is intended and
+ * supplied to you, the Companys customer, for use solely and
+ * exclusively on Microchip PICmicro Microcontroller products. The
+ * software is owned by the Company and/or its supplier, and is
+ * protected under applicable copyright laws. All rights are reserved.
+ * Any use in violation of the foregoing restrictions may subject the
+ * user to criminal sanctions under applicable laws, as well as to
+ * civil liability for the breach of the terms and conditions of this
+ * license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * Author               Date        Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Rawin Rojvanit       11/19/04    Original.
+ ********************************************************************/
+#ifndef USB_H
+#define USB_H
+
+/*
+ * usb.h provides a centralize way to include all files
+ * required by Microchip USB Firmware.
+ *
+ * The order of inclusion is important.
+ * Dependency conflicts are resolved by the correct ordering.
+ */
+
+#include "usbcfg.h"
+#include "usbdefs_std_dsc.h"
+#include "usbdsc.h"
+
+#include "usbdefs_ep0_buff.h"
+#include "usbmmap.h"
+
+#include "usbdrv.h"
+#include "usbctrltrf.h"
+#include "usb9.h"
+
+#if defined(USB_USE_HID)                // See autofiles\usbcfg.h
+#include "hid.h"
+#endif
+
+#if defined(USB_USE_GEN)                // See autofiles\usbcfg.h
+#include "usbgen.h"
+#endif
+
+#endif //USB_H
@@ -1,70 +1,105 @@
-/*********************************************************************
- *
- *                Microchip USB C18 Firmware Version 1.0
- *
- *********************************************************************
- * FileName:        usbdsc.h
- * Dependencies:    See INCLUDES section below
- * Processor:       PIC18
- * Compiler:        C18 2.30.01+
- * Company:         Microchip Technology, Inc.
- *
- * Software License Agreement
- *
- * The software supplied herewith by Microchip Technology Incorporated
- * (the Company) for its PICmicro Microcontroller is intended and
- * supplied to you, the Companys customer, for use solely and
- * exclusively on Microchip PICmicro Microcontroller products. The
- * software is owned by the Company and/or its supplier, and is
- * protected under applicable copyright laws. All rights are reserved.
- * Any use in violation of the foregoing restrictions may subject the
- * user to criminal sanctions under applicable laws, as well as to
- * civil liability for the breach of the terms and conditions of this
- * license.
- *
- * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
- * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
- * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
- * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
- * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
- * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
- *
- ********************************************************************/
-
-/*********************************************************************
- * Descriptor specific type definitions are defined in:
- * system\usb\usbdefs\usbdefs_std_dsc.h
- ********************************************************************/
-
-#ifndef USBDSC_H
-#define USBDSC_H
-
-/** I N C L U D E S *************************************************/
-#include "typedefs.h"
-#include "usbcfg.h"
-
-#if defined(USB_USE_HID)
-#include "hid.h"
-#endif
-
-#include "usb.h"
-
-/** D E F I N I T I O N S *******************************************/
-#define CFG01 rom struct            \
-{   USB_CFG_DSC     cd01;           \
-    USB_INTF_DSC    i00a00;         \
-    USB_HID_DSC     hid_i00a00;     \
-    USB_EP_DSC      ep01i_i00a00;   \
-    USB_EP_DSC		ep01o_i00a00;	\
-} cfg01
-
-/** E X T E R N S ***************************************************/
-extern rom USB_DEV_DSC device_dsc;
-extern CFG01;
-extern rom const unsigned char *rom USB_CD_Ptr[];
-extern rom const unsigned char *rom USB_SD_Ptr[];
-
-extern rom struct{byte report[HID_RPT01_SIZE];} hid_rpt01;
-extern rom pFunc ClassReqHandler[1];
-
-#endif //USBDSC_H
+/*********************************************************************
+ *
+ *                Microchip USB C18 Firmware Version 1.0
+ *
+ *********************************************************************
+ * FileName:        usbdsc.h
+ * Dependencies:    See INCLUDES section below
+ * Processor:       PIC18
+ * Compiler:        C18 2.30.01+
+ * Company:         Microchip Technology, Inc.
+ *
+ * Software License Agreement
+ *
+ * The software supplied herewith by Microchip Technology Incorporated
+ * (the Company) for its PICmicro® Microcontroller is intended and
+ * supplied to you, the Companys customer, for use solely and
+ * exclusively on Microchip PICmicro Microcontroller products. The
+ * software is owned by the Company and/or its supplier, and is
+ * protected under applicable copyright laws. All rights are reserved.
+ * Any use in violation of the foregoing restrictions may subject the
+ * user to criminal sanctions under applicable laws, as well as to
+ * civil liability for the breach of the terms and conditions of this
+ * license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ ********************************************************************/
+
+/*********************************************************************
+ * Descriptor specific type definitions are defined in:
+ * system\usb\usbdefs\usbdefs_std_dsc.h
+ ********************************************************************/
+
+#ifndef USBDSC_H
+#define USBDSC_H
+
+/** I N C L U D E S *************************************************/
+#include "typedefs.h"
+#include "usbcfg.h"
+
+#if defined(USB_USE_HID)
+#include "hid.h"
+#endif
+
+#if defined(USB_USE_GEN)
+#include "usbgen.h"
+#endif
+
+#include "usb.h"
+
+/** D E F I N I T I O N S *******************************************/
+/*
+ * The structures are declared once, with a tag, rather than spelled out in
+ * both the extern below and the definition in usbdsc.c.  C18 takes two
+ * anonymous structs with the same members as the same type, but standard C
+ * (the host build, see SK28A Host Tools/sim) doesn't.
+ */
+#if defined(USB_USE_GEN)
+struct _CFG01
+{   USB_CFG_DSC     cd01;
+    USB_INTF_DSC    i00a00;
+    USB_EP_DSC      ep02i_i00a00;
+    USB_EP_DSC		ep02o_i00a00;
+};
+#else
+struct _CFG01
+{   USB_CFG_DSC     cd01;
+    USB_INTF_DSC    i00a00;
+    USB_HID_DSC     hid_i00a00;
+    USB_EP_DSC      ep01i_i00a00;
+    USB_EP_DSC		ep01o_i00a00;
+};
+#endif
+#define CFG01 rom struct _CFG01 cfg01
+
+#if defined(USB_USE_HID)
+struct _HID_RPT01 {byte report[HID_RPT01_SIZE];};
+#endif
+
+#if defined(USE_SERIAL_NUMBER_STRING)
+#define SERIAL_NUMBER_STR_INDEX 3   // Served from RAM by USBStdGetDscHandler(), not through USB_SD_Ptr
+struct _SERIAL_NUMBER_DSC {byte bLength;byte bDscType;word string[16];};   // Two hex digits per User ID byte
+#endif
+
+/** E X T E R N S ***************************************************/
+extern rom USB_DEV_DSC device_dsc;
+extern CFG01;
+extern rom const unsigned char *rom USB_CD_Ptr[];
+extern rom const unsigned char *rom USB_SD_Ptr[];
+
+#if defined(USB_USE_HID)
+extern rom struct _HID_RPT01 hid_rpt01;
+#endif
+extern rom pFunc ClassReqHandler[1];
+
+#if defined(USE_SERIAL_NUMBER_STRING)
+extern struct _SERIAL_NUMBER_DSC sd003;
+#endif
+
+#endif //USBDSC_H
@@ -0,0 +1,293 @@
+/*********************************************************************
+ *
+ *             Microchip USB C18 Firmware -  Generic Version 1.0
+ *
+ *********************************************************************
+ * FileName:        usbgen.c
+ * Dependencies:    See INCLUDES section below
+ * Processor:       PIC18
+ * Compiler:        C18 2.30.01+
+ * Company:         Microchip Technology, Inc.
+ *
+ * Software License Agreement
+ *
+ * The software supplied herewith by Microchip Technology Incorporated
+ * (the Company) for its PICmicro® Microcontroller is intended and
+ * supplied to you, the Companys customer, for use solely and
+ * exclusively on Microchip PICmicro Microcontroller products. The
+ * software is owned by the Company and/or its supplier, and is
+ * protected under applicable copyright laws. All rights are reserved.
+ * Any use in violation of the foregoing restrictions may subject the
+ * user to criminal sanctions under applicable laws, as well as to
+ * civil liability for the breach of the terms and conditions of this
+ * license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * Author               Date        Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *                      10/16/26    Original.  Vendor class (bulk endpoint)
+ *                                  counterpart of hid.c.
+ ********************************************************************/
+
+/** I N C L U D E S **********************************************************/
+#include <p18cxxx.h>
+#include "typedefs.h"
+#include "usb.h"
+
+#ifdef USB_USE_GEN
+
+/** V A R I A B L E S ********************************************************/
+#pragma udata
+byte usbgen_rx_len;
+#if defined(USB_USE_PING_PONG)
+volatile far union _BDT *pUSBGenBdOut;
+volatile far union _BDT *pUSBGenBdIn;
+#endif
+
+/** D E C L A R A T I O N S **************************************************/
+#pragma code
+
+/** C L A S S  S P E C I F I C  R E Q ****************************************/
+/******************************************************************************
+ * Function:        void USBCheckGenRequest(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        The vendor class interface doesn't need any class or
+ *                  vendor specific requests, since all bootloader commands
+ *                  travel over the bulk endpoints.  This routine only exists
+ *                  so the ClassReqHandler table in usbdsc.c has an entry.
+ *                  Leaving ctrl_trf_session_owner alone makes the request
+ *                  get stalled by usbctrltrf.c, like any unknown request.
+ *
+ * Note:            None
+ *****************************************************************************/
+void USBCheckGenRequest(void)
+{
+}//end USBCheckGenRequest
+
+/** U S E R  A P I ***********************************************************/
+
+/******************************************************************************
+ * Function:        void USBGenInitEP(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        USBGenInitEP initializes the bulk endpoints, buffer
+ *                  descriptors, and variables.
+ *                  It should be called after the USB host has sent out a
+ *                  SET_CONFIGURATION request.
+ *                  See USBStdSetCfgHandler() in usb9.c for examples.
+ *
+ * Note:            None
+ *****************************************************************************/
+void USBGenInitEP(void)
+{   
+    usbgen_rx_len = 0;
+    
+    USBGEN_UEP = EP_OUT_IN|HSHK_EN;             // Enable 2 data pipes
+    
+    USBGEN_BD_OUT.Cnt = sizeof(usbgen_out);     // Set buffer size
+    USBGEN_BD_OUT.ADR = (byte*)&usbgen_out;     // Set buffer address
+    USBGEN_BD_OUT.Stat._byte = _USIE|_DAT0|_DTSEN;// Set status
+
+    #if defined(USB_USE_PING_PONG)
+    USBGEN_BD_OUT_ODD.Cnt = sizeof(usbgen_out_odd);     // See HIDInitEP() in hid.c
+    USBGEN_BD_OUT_ODD.ADR = (byte*)&usbgen_out_odd;
+    USBGEN_BD_OUT_ODD.Stat._byte = _USIE|_DAT1|_DTSEN;
+    pUSBGenBdOut = &USBGEN_BD_OUT;
+    #endif
+
+    /*
+     * Do not have to init Cnt of IN pipes here.
+     * See HIDInitEP() in hid.c for the reason.
+     */
+    USBGEN_BD_IN.ADR = (byte*)&usbgen_in;       // Set buffer address
+    #if defined(USB_USE_PING_PONG)
+    USBGEN_BD_IN.Stat._byte = _UCPU|_DAT0;      // Set status, see mUSBPPBufferReady()
+    USBGEN_BD_IN_ODD.ADR = (byte*)&usbgen_in_odd;
+    USBGEN_BD_IN_ODD.Stat._byte = _UCPU|_DAT1;
+    pUSBGenBdIn = &USBGEN_BD_IN;
+    #else
+    USBGEN_BD_IN.Stat._byte = _UCPU|_DAT1;      // Set status
+    #endif
+
+}//end USBGenInitEP
+
+/******************************************************************************
+ * Function:        void USBGenWrite(char *buffer, byte len)
+ *
+ * PreCondition:    mUSBGenTxIsBusy() must return false.
+ *
+ *                  Value of 'len' must be equal to or smaller than
+ *                  USBGEN_EP_SIZE.
+ *
+ * Input:           buffer  : Pointer to the starting location of data bytes
+ *                  len     : Number of bytes to be transferred
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Use this function to transfer data located in data memory
+ *                  to the host over the bulk IN endpoint.
+ *
+ *                  Remember: mUSBGenTxIsBusy() must return false before user
+ *                  can call this function.
+ *
+ *                  Typical Usage:
+ *                  if(!mUSBGenTxIsBusy())
+ *                      USBGenWrite(buffer, 64);
+ *
+ * Note:            None
+ *****************************************************************************/
+void USBGenWrite(char *buffer, byte len)
+{
+	byte i;
+	
+    /*
+     * Value of len should be equal to or smaller than USBGEN_EP_SIZE.
+     * This check forces the value of len to meet the precondition.
+     */
+	if(len > USBGEN_EP_SIZE)
+	    len = USBGEN_EP_SIZE;
+
+   /*
+    * Copy data from user's buffer to dual-ram buffer
+    */
+    for (i = 0; i < len; i++)
+    	mUSBGenTxBufferAdr()[i] = buffer[i];
+
+    USBGenSend(len);
+
+}//end USBGenWrite
+
+/******************************************************************************
+ * Function:        byte USBGenRead(char *buffer, byte len)
+ *
+ * PreCondition:    Input argument 'buffer' should point to a buffer area
+ *                  that is bigger or equal to the size specified by 'len'.
+ *
+ * Input:           buffer  : Pointer to where received bytes are to be stored
+ *                  len     : The number of bytes expected.
+ *
+ * Output:          The number of bytes copied to buffer.
+ *
+ * Side Effects:    Publicly accessible variable usbgen_rx_len is updated
+ *                  with the number of bytes copied to buffer.
+ *
+ * Overview:        USBGenRead copies a string of bytes received through the
+ *                  bulk OUT endpoint to a user's specified location.
+ *                  It is a non-blocking function, and returns '0' if there
+ *                  is no data available.  Same semantics as HIDRxReport().
+ *
+ * Note:            None
+ *****************************************************************************/
+byte USBGenRead(char *buffer, byte len)
+{
+    usbgen_rx_len = 0;
+    
+    if(!mUSBGenRxIsBusy())
+    {
+        /*
+         * Adjust the expected number of bytes to equal
+         * the actual number of bytes received.
+         */
+        if(len > mUSBGenGetRxCount())
+            len = mUSBGenGetRxCount();
+        
+        /*
+         * Copy data from dual-ram buffer to user's buffer
+         */
+        for(usbgen_rx_len = 0; usbgen_rx_len < len; usbgen_rx_len++)
+            buffer[usbgen_rx_len] = mUSBGenRxBufferAdr()[usbgen_rx_len];
+
+        /*
+         * Prepare dual-ram buffer for next OUT transaction
+         */
+        USBGenRxRelease();
+    }//end if
+    
+    return usbgen_rx_len;
+    
+}//end USBGenRead
+
+/******************************************************************************
+ * Function:        void USBGenSend(byte len)
+ *
+ * PreCondition:    mUSBGenTxIsBusy() must return false, and the data has
+ *                  already been put in the buffer at mUSBGenTxBufferAdr().
+ *
+ * Input:           len     : Number of bytes to be transferred
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Hands the bulk IN endpoint buffer to the SIE.  Same as
+ *                  HIDTxSend() in hid.c.
+ *
+ * Note:            None
+ *****************************************************************************/
+void USBGenSend(byte len)
+{
+    #if defined(USB_USE_PING_PONG)
+    pUSBGenBdIn->Cnt = len;
+    mUSBPPBufferReady((*pUSBGenBdIn));
+    pUSBGenBdIn = (pUSBGenBdIn == &USBGEN_BD_IN) ? &USBGEN_BD_IN_ODD : &USBGEN_BD_IN;
+    #else
+    USBGEN_BD_IN.Cnt = len;
+    mUSBBufferReady(USBGEN_BD_IN);
+    #endif
+}//end USBGenSend
+
+/******************************************************************************
+ * Function:        void USBGenRxRelease(void)
+ *
+ * PreCondition:    mUSBGenRxIsBusy() returned false, and the caller is done
+ *                  with the data at mUSBGenRxBufferAdr().
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Gives the bulk OUT endpoint buffer back to the SIE.  Same
+ *                  as HIDRxRelease() in hid.c.
+ *
+ * Note:            None
+ *****************************************************************************/
+void USBGenRxRelease(void)
+{
+    #if defined(USB_USE_PING_PONG)
+    pUSBGenBdOut->Cnt = USBGEN_EP_SIZE;
+    mUSBPPBufferReady((*pUSBGenBdOut));
+    pUSBGenBdOut = (pUSBGenBdOut == &USBGEN_BD_OUT) ? &USBGEN_BD_OUT_ODD : &USBGEN_BD_OUT;
+    #else
+    USBGEN_BD_OUT.Cnt = sizeof(usbgen_out);
+    mUSBBufferReady(USBGEN_BD_OUT);
+    #endif
+}//end USBGenRxRelease
+
+#endif //def USB_USE_GEN
+
+/** EOF usbgen.c ************************************************************/
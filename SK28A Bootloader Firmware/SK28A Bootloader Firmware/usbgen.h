@@ -0,0 +1,176 @@
+/*********************************************************************
+ *
+ *             Microchip USB C18 Firmware -  Generic Version 1.0
+ *
+ *********************************************************************
+ * FileName:        usbgen.h
+ * Dependencies:    See INCLUDES section below
+ * Processor:       PIC18
+ * Compiler:        C18 2.30.01+
+ * Company:         Microchip Technology, Inc.
+ *
+ * Software License Agreement
+ *
+ * The software supplied herewith by Microchip Technology Incorporated
+ * (the Company) for its PICmicro® Microcontroller is intended and
+ * supplied to you, the Companys customer, for use solely and
+ * exclusively on Microchip PICmicro Microcontroller products. The
+ * software is owned by the Company and/or its supplier, and is
+ * protected under applicable copyright laws. All rights are reserved.
+ * Any use in violation of the foregoing restrictions may subject the
+ * user to criminal sanctions under applicable laws, as well as to
+ * civil liability for the breach of the terms and conditions of this
+ * license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN AS IS CONDITION. NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE COMPANY SHALL NOT,
+ * IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * Author               Date        Comment
+ *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *                      10/16/26    Original.  Vendor class (bulk endpoint)
+ *                                  counterpart of hid.c.
+ ********************************************************************/
+#ifndef USBGEN_H
+#define USBGEN_H
+
+/** I N C L U D E S **********************************************************/
+#include "typedefs.h"
+
+/** D E F I N I T I O N S ****************************************************/
+
+/* Vendor Specific Interface Class Code */
+#define VENDOR_INTF                 0xFF
+
+/******************************************************************************
+ * Macro:           (bit) mUSBGenRxIsBusy(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        This macro is used to check if the bulk OUT endpoint is
+ *                  busy (owned by SIE) or not.
+ *                  Typical Usage: if(mUSBGenRxIsBusy())
+ *
+ * Note:            None
+ *****************************************************************************/
+#if defined(USB_USE_PING_PONG)
+#define mUSBGenRxIsBusy()           pUSBGenBdOut->Stat.UOWN
+#else
+#define mUSBGenRxIsBusy()           USBGEN_BD_OUT.Stat.UOWN
+#endif
+
+/******************************************************************************
+ * Macro:           (bit) mUSBGenTxIsBusy(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        This macro is used to check if the bulk IN endpoint is
+ *                  busy (owned by SIE) or not.
+ *                  Typical Usage: if(mUSBGenTxIsBusy())
+ *
+ * Note:            None
+ *****************************************************************************/
+#if defined(USB_USE_PING_PONG)
+#define mUSBGenTxIsBusy()           pUSBGenBdIn->Stat.UOWN
+#else
+#define mUSBGenTxIsBusy()           USBGEN_BD_IN.Stat.UOWN
+#endif
+
+/******************************************************************************
+ * Macro:           byte* mUSBGenRxBufferAdr(void)
+ *                  byte* mUSBGenTxBufferAdr(void)
+ *                  byte mUSBGenGetRxCount(void)
+ *
+ * PreCondition:    mUSBGenRxIsBusy() (or mUSBGenTxIsBusy()) must return false.
+ *
+ * Input:           None
+ *
+ * Output:          See mHIDRxBufferAdr() in hid.h.
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Direct access to the bulk endpoint buffers.  Hand them
+ *                  back to the SIE with USBGenRxRelease() and USBGenSend().
+ *
+ * Note:            None
+ *****************************************************************************/
+#if defined(USB_USE_PING_PONG)
+#define mUSBGenRxBufferAdr()        (pUSBGenBdOut->ADR)
+#define mUSBGenTxBufferAdr()        (pUSBGenBdIn->ADR)
+#define mUSBGenGetRxCount()         (pUSBGenBdOut->Cnt)
+#else
+#define mUSBGenRxBufferAdr()        ((byte*)&usbgen_out)
+#define mUSBGenTxBufferAdr()        ((byte*)&usbgen_in)
+#define mUSBGenGetRxCount()         (USBGEN_BD_OUT.Cnt)
+#endif
+
+/******************************************************************************
+ * Macro:           byte mUSBGenGetRxLength(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          mUSBGenGetRxLength returns usbgen_rx_len
+ *
+ * Side Effects:    None
+ *
+ * Overview:        mUSBGenGetRxLength is used to retrieve the number of bytes
+ *                  copied to user's buffer by the most recent call to
+ *                  USBGenRead function.
+ *
+ * Note:            None
+ *****************************************************************************/
+#define mUSBGenGetRxLength()        usbgen_rx_len
+
+/******************************************************************************
+ * Macro:           void mUSBGenResetPingPong(void)
+ *
+ * PreCondition:    USB_USE_PING_PONG is defined, and UCONbits.PPBRST has
+ *                  just pointed the SIE at the even buffer descriptors.
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        See mHIDResetPingPong() in hid.h.
+ *
+ * Note:            None
+ *****************************************************************************/
+#if defined(USB_USE_PING_PONG)
+#define mUSBGenResetPingPong()      {pUSBGenBdOut = &USBGEN_BD_OUT; pUSBGenBdIn = &USBGEN_BD_IN;}
+#endif
+
+/** E X T E R N S ************************************************************/
+extern byte usbgen_rx_len;
+#if defined(USB_USE_PING_PONG)
+extern volatile far union _BDT *pUSBGenBdOut;     // Next OUT buffer descriptor (even or odd) to be read
+extern volatile far union _BDT *pUSBGenBdIn;      // Next IN buffer descriptor (even or odd) to be filled
+#endif
+
+/** P U B L I C  P R O T O T Y P E S *****************************************/
+void USBGenInitEP(void);
+void USBCheckGenRequest(void);
+void USBGenWrite(char *buffer, byte len);
+byte USBGenRead(char *buffer, byte len);
+void USBGenSend(byte len);
+void USBGenRxRelease(void);
+
+#endif //USBGEN_H
@@ -0,0 +1,57 @@
+// Flashing several boards at once, for fixtures with a row of them plugged in.
+#ifndef SK28A_BOARD_POOL_H
+#define SK28A_BOARD_POOL_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sk28a/flasher.h"
+#include "sk28a/image.h"
+#include "sk28a/protocol.h"
+#include "sk28a/transport.h"
+
+namespace sk28a {
+
+struct BoardTarget {
+    std::string name;      // As the board is reported, e.g. its hidraw node
+    std::string location;  // Port it sits on, if known
+    std::function<std::unique_ptr<Transport>()> open;
+    std::optional<UserId> user_id;  // Written into the board's User ID on top of the image (serial stamping)
+    std::string journal;            // Progress journal to resume from and keep (see Flasher), if not empty
+};
+
+struct BoardResult {
+    std::string name;
+    std::string location;
+    bool ok = false;
+    std::string error;  // What went wrong, if !ok
+    uint64_t bytes = 0;
+    uint64_t resumed = 0;  // Of those, the ones the journal found already on the board
+    std::chrono::milliseconds elapsed{0};
+    TransportStats stats;
+};
+
+// Called from the worker flashing board `index`, so from several threads at once
+using BoardProgressCallback =
+    std::function<void(size_t index, std::string_view phase, uint64_t done, uint64_t total)>;
+// Called from a worker as each board finishes
+using BoardDoneCallback = std::function<void(size_t index, const BoardResult& result)>;
+
+// Flashes the image into every board, up to `jobs` of them at a time (0: all
+// at once).  Each worker runs its own Flasher, so a board that is slow to
+// answer or fails holds up nobody else; its error ends up in its result.
+// Results are in the order of `boards`.
+std::vector<BoardResult> flash_boards(const std::vector<BoardTarget>& boards, const ImageView& image,
+                                      const FlashOptions& options, unsigned jobs = 0,
+                                      const BoardProgressCallback& progress = {},
+                                      const BoardDoneCallback& done = {});
+
+}  // namespace sk28a
+
+#endif  // SK28A_BOARD_POOL_H
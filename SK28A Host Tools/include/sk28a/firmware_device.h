@@ -0,0 +1,57 @@
+// The bootloader firmware itself, compiled for the host (sim/firmware_sim.h),
+// behind the Transport interface.  Unlike SimDevice, which re-implements the
+// protocol, this runs BootPIC18NonJ.c and the USB stack against a model of
+// the PIC18F2550, so it exercises whatever the firmware build does.
+//
+// Timeouts are in the model's virtual time, not wall clock time, which also
+// makes virtual_time() a prediction of how long the same exchange takes with
+// a board: flash and EEPROM writes, the HID 1 ms frames and the main loop
+// are charged what they cost on the part (see sim/pic18_model.h).
+#ifndef SK28A_FIRMWARE_DEVICE_H
+#define SK28A_FIRMWARE_DEVICE_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "sk28a/transport.h"
+
+namespace sk28a {
+
+class FirmwareDevice : public Transport {
+public:
+    // Powers the part on and enumerates it.  There can only be one at a time.
+    FirmwareDevice();
+    ~FirmwareDevice() override;
+    FirmwareDevice(const FirmwareDevice&) = delete;
+    FirmwareDevice& operator=(const FirmwareDevice&) = delete;
+
+    void write(const Packet& packet) override;
+    bool read(Packet& packet, std::chrono::milliseconds timeout) override;
+    std::string description() const override { return "host build of the bootloader firmware"; }
+
+    // GET_DESCRIPTOR on EP0.  The HID report descriptor (type 0x22) is asked of the interface.
+    std::vector<uint8_t> descriptor(uint8_t type, uint8_t index = 0, uint16_t language = 0);
+    // CLEAR_FEATURE(ENDPOINT_HALT) on EP0, as libusb_clear_halt() sends it
+    void clear_halt(uint8_t endpoint);
+
+    uint8_t peek(uint32_t address) const;
+    void poke(uint32_t address, uint8_t value);  // Bypasses the flash rules, for setting up a scenario
+    unsigned long reset_count() const;
+    uint64_t nak_count() const { return nak_count_; }  // OUT reports the firmware wasn't ready for
+    std::chrono::microseconds nak_time() const;         // From the first NAK of a report until it was taken
+    std::chrono::microseconds virtual_time() const;     // Since power on
+    std::chrono::microseconds write_time() const;       // Of that, waiting for flash/EEPROM writes
+
+private:
+    void step();
+
+    std::deque<Packet> responses_;
+    uint64_t nak_count_ = 0;
+    uint64_t nak_cycles_ = 0;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_FIRMWARE_DEVICE_H
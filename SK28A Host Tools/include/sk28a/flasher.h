@@ -0,0 +1,139 @@
+// Erase/program/verify sequence on top of a Transport.
+#ifndef SK28A_FLASHER_H
+#define SK28A_FLASHER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "sk28a/image.h"
+#include "sk28a/protocol.h"
+#include "sk28a/transport.h"
+
+namespace sk28a {
+
+class Journal;
+
+enum class EraseMode {
+    Full,   // ERASE_DEVICE, like HIDBootLoader.exe
+    Range,  // ERASE_RANGE over the span the image uses (ExtEraseRange)
+    Lazy,   // No erase pass, the device erases rows on first write (ExtLazyErase)
+    None,
+    Patch,  // No erase pass, PATCH_DEVICE rewrites the rows the image touches and keeps the rest of them (ExtPatch)
+};
+
+enum class VerifyMode {
+    Read,  // Read everything back (READ_STREAM if available, else pipelined GET_DATA)
+    Crc,   // Compare a device-side CRC per section (ExtVerifyRange)
+    None,
+};
+
+struct FlashOptions {
+    EraseMode erase = EraseMode::Full;
+    VerifyMode verify = VerifyMode::Read;
+    bool program_config = false;  // The config words are only written when asked for
+    bool reset = true;
+    unsigned window = 4;          // Requests kept in flight while reading back
+    std::chrono::milliseconds timeout{2000};
+    std::chrono::milliseconds erase_timeout{15000};
+};
+
+class VerifyError : public std::runtime_error {
+public:
+    VerifyError(uint32_t address, uint8_t expected, uint8_t actual);
+
+    uint32_t address;
+    uint8_t expected;
+    uint8_t actual;
+};
+
+// What the last program() sent for the image, to tell how much PROGRAM_COMPRESSED and FILL saved
+struct ProgramStats {
+    uint64_t bytes = 0;    // Image bytes programmed
+    uint64_t payload = 0;  // Data bytes the packets carried for them (a FILL carries its one value)
+    uint64_t packets = 0;
+    uint64_t compressed_packets = 0;
+    uint64_t fill_packets = 0;
+
+    double ratio() const { return payload != 0 ? static_cast<double>(bytes) / payload : 1.0; }
+};
+
+using ProgressCallback = std::function<void(std::string_view phase, uint64_t done, uint64_t total)>;
+
+// Images are taken as views (an Image converts to one).  With a view of an
+// .sk28img, VERIFY_RANGE is checked against the CRCs the file stores for its
+// rows where they apply, instead of CRCs worked out from the bytes.
+class Flasher {
+public:
+    explicit Flasher(Transport& transport, FlashOptions options = {});
+
+    void set_progress(ProgressCallback progress) { progress_ = std::move(progress); }
+    const FlashOptions& options() const { return options_; }
+
+    // Discards stale reports and asks the device for its memory map.
+    const DeviceInfo& query();
+    const DeviceInfo& info() const { return info_; }
+    const ProgramStats& program_stats() const { return stats_; }
+
+    // The part of an image this device can take: the regions from QUERY_DEVICE,
+    // minus the config words unless program_config is set.  Everything else
+    // (such as the bootloader's own 0x000-0xFFF block) is dropped.  The view
+    // points into the same bytes as `image`.
+    ImageView writable_part(const ImageView& image) const;
+
+    void erase(const ImageView& image);
+    void program(const ImageView& image);
+    void verify(const ImageView& image);
+    std::vector<uint8_t> read(uint32_t address, uint32_t length);
+    void reset();
+
+    // query(), then erase/program/verify/reset as configured
+    void flash(const ImageView& image);
+
+    // flash(), picking up where an interrupted run for the same image left
+    // off.  What the journal says is programmed gets checked against the board
+    // (VERIFY_RANGE, else reading back), and programming resumes at the first
+    // block that doesn't match, without erasing what comes before it.  The rest
+    // goes in chunks, each verified and journaled as it is committed.  The
+    // journal is removed once the image is in.  Returns how many of the bytes
+    // the board already had.
+    uint64_t flash(const ImageView& image, Journal& journal);
+
+private:
+    Packet await(Command expected, std::chrono::milliseconds timeout);
+    void sync(std::chrono::milliseconds timeout);
+    void wait_for_background_erase();
+    ImageView program_part(const ImageView& image) const;
+    void send_section(const ImageView::Run& section, uint64_t& done, uint64_t total);
+    // Everything but the config words
+    void send_sections(const ImageView& part, uint64_t& done, uint64_t total);
+    void program_config_words(const ImageView& part, uint64_t& done, uint64_t total);
+    void check_verify_mode() const;
+    uint16_t device_crc(uint32_t address, uint32_t length);
+    // VERIFY_RANGE over the rows the run is in matches the CRCs the .sk28img behind `image` stores for them.
+    // False if it doesn't, or they don't apply (see the definition).
+    bool rows_check_out(const ImageView& image, const ImageView::Run& run);
+    // `run` is one of `image`'s
+    void verify_section(const ImageView& image, const ImageView::Run& run);
+    void verify_bytes(const ImageView::Run& expected);
+    // Address of the first byte on the device that isn't as expected (with VERIFY_RANGE, of its block)
+    uint32_t first_mismatch(const ImageView& image, const ImageView::Run& expected);
+    // Where a resumed run can start, given that the journal has everything below `done` programmed
+    uint32_t check_journaled(const ImageView& body, uint32_t done);
+    // From `from` on; `erased`: the flash there is known to be erased, so blank blocks needn't be sent
+    void program_journaled(const ImageView& image, uint32_t from, bool erased, Journal& journal);
+    void report(std::string_view phase, uint64_t done, uint64_t total);
+
+    Transport& transport_;
+    FlashOptions options_;
+    DeviceInfo info_;
+    ProgressCallback progress_;
+    ProgramStats stats_;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_FLASHER_H
@@ -0,0 +1,42 @@
+// Linux hidraw link to a bootloader running the HID transport (the default
+// USB_USE_HID build).  The vendor class bulk build (USB_USE_GEN) is not
+// claimed by the kernel HID driver and has no hidraw node; see
+// libusb_transport.h.
+#ifndef SK28A_HIDRAW_TRANSPORT_H
+#define SK28A_HIDRAW_TRANSPORT_H
+
+#include <string>
+#include <vector>
+
+#include "sk28a/transport.h"
+
+namespace sk28a {
+
+struct HidrawDevice {
+    std::string path;  // /dev/hidrawN
+    std::string phys;  // USB topology path, stable for a given port
+    std::string uniq;  // Serial number string, empty if the device has none
+};
+
+// All hidraw nodes whose HID_ID matches vendor_id:product_id, sorted by path.
+std::vector<HidrawDevice> find_hidraw_devices(uint16_t vendor_id = kVendorId, uint16_t product_id = kProductId);
+
+class HidrawTransport : public Transport {
+public:
+    explicit HidrawTransport(const std::string& path);
+    ~HidrawTransport() override;
+    HidrawTransport(const HidrawTransport&) = delete;
+    HidrawTransport& operator=(const HidrawTransport&) = delete;
+
+    void write(const Packet& packet) override;
+    bool read(Packet& packet, std::chrono::milliseconds timeout) override;
+    std::string description() const override { return path_; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_HIDRAW_TRANSPORT_H
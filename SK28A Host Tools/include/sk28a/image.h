@@ -0,0 +1,250 @@
+// Sparse memory image, as loaded from an Intel HEX file or an .sk28img file.
+#ifndef SK28A_IMAGE_H
+#define SK28A_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sk28a {
+
+// Unreadable or malformed image file
+class ImageError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class HexError : public ImageError {
+public:
+    using ImageError::ImageError;
+};
+
+// Byte addressed (BytesPerAddress = 1 on PIC18), stored as maximal runs of
+// contiguous bytes keyed by their start address.
+class Image {
+public:
+    using Segments = std::map<uint32_t, std::vector<uint8_t>>;
+
+    // Later writes win where they overlap earlier ones.
+    void write(uint32_t address, const uint8_t* data, size_t size);
+
+    const Segments& segments() const { return segments_; }
+    bool empty() const { return segments_.empty(); }
+    size_t byte_count() const;
+
+    // The part of the image inside [begin, end)
+    Image slice(uint32_t begin, uint32_t end) const;
+
+    // Without the all-0xFF blocks (aligned to block_size) inside [begin, end), for flash that has just been
+    // erased: WriteFlashBlock() pads whatever isn't sent with 0xFF anyway.  A blank run in the middle of a
+    // segment splits it in two, which costs a PROGRAM_COMPLETE, so it is only left out from min_run blocks up.
+    Image without_blank_blocks(uint32_t block_size, uint32_t begin, uint32_t end, unsigned min_run = 4) const;
+
+private:
+    Segments segments_;
+};
+
+class ImageFile;
+
+// An image as runs of contiguous bytes that point to where the bytes already
+// are: an Image's segments, or the rows of a mapped .sk28img, so nothing is
+// copied on the way to the board.  What it points into has to outlive it.
+// Runs are in address order and as long as the bytes are contiguous, the
+// same as the segments of an Image with the same bytes.
+//
+// A view of an ImageFile also has the CRC the file stores for each row, for
+// VERIFY_RANGE to be checked against without going over the bytes again.
+class ImageView {
+public:
+    struct Run {
+        uint32_t address;
+        const uint8_t* data;
+        size_t size;
+
+        uint32_t end() const { return address + static_cast<uint32_t>(size); }
+    };
+
+    ImageView() = default;
+    ImageView(const Image& image);  // Implicit, so an Image goes wherever a view does
+    ImageView(const ImageFile& file);
+
+    const std::vector<Run>& runs() const { return runs_; }
+    bool empty() const { return runs_.empty(); }
+    size_t byte_count() const;
+
+    // The part of the image inside [begin, end)
+    ImageView slice(uint32_t begin, uint32_t end) const;
+    // The part inside any of the [begin, end) ranges
+    ImageView slices(std::vector<std::pair<uint32_t, uint32_t>> ranges) const;
+    // See Image::without_blank_blocks()
+    ImageView without_blank_blocks(uint32_t block_size, uint32_t begin, uint32_t end, unsigned min_run = 4) const;
+    // With these bytes written over the image, as Image::write() does.  The
+    // runs they join are copied into the view, and the rows they touch lose
+    // their stored CRC.
+    ImageView with(uint32_t address, const uint8_t* data, size_t size) const;
+
+    // The CRC the .sk28img stores for the row at `address` (kEraseRowSize
+    // aligned), and which of its bytes the image has.  False if there is no
+    // such row, or it has been written over since.
+    bool stored_row(uint32_t address, uint16_t& crc, uint64_t& present) const;
+
+    Image to_image() const;
+
+private:
+    std::vector<Run> runs_;
+    const ImageFile* file_ = nullptr;
+    std::vector<std::pair<uint32_t, uint32_t>> written_;  // Ranges with()
+    std::vector<std::shared_ptr<const std::vector<uint8_t>>> owned_;  // Runs with() copied
+};
+
+// Sparse map of fixed size pages (a power of two up to 64 bytes, normally
+// ProgramBlockSize), for collecting the records of a hex file.  Storage is
+// pooled, so writing into pages that already exist doesn't allocate, and
+// records in ascending order (as hex files have them) find their page at once.
+class PageMap {
+public:
+    explicit PageMap(uint32_t page_size = 32);
+
+    void write(uint32_t address, const uint8_t* data, size_t size);
+
+    uint32_t page_size() const { return page_size_; }
+    size_t page_count() const { return index_.size(); }
+    size_t byte_count() const;
+
+    struct Page {
+        uint32_t address;
+        const uint8_t* bytes;  // page_size() of them, 0xFF where nothing was written
+        uint64_t present;      // Bit n set if bytes[n] was written
+    };
+    // In address order
+    Page page(size_t i) const;
+
+    // Maximal runs of written bytes
+    Image to_image() const;
+
+private:
+    struct Slot {
+        uint32_t address;
+        uint32_t pool_index;
+    };
+    size_t find_or_add(uint32_t page_address);
+
+    uint32_t page_size_;
+    std::vector<Slot> index_;  // Sorted by address
+    std::vector<uint8_t> bytes_;
+    std::vector<uint64_t> present_;
+    size_t last_ = 0;  // Position in index_ of the last page written
+};
+
+// Streaming parser: calls on_data for each data record, with the extended
+// segment/linear address (types 02/04) already applied.  data points into a
+// buffer that is reused for the next record.
+using HexDataCallback = std::function<void(uint32_t address, const uint8_t* data, size_t size)>;
+void scan_hex(std::string_view text, const std::string& name, const HexDataCallback& on_data);
+
+Image parse_hex(std::string_view text, const std::string& name = "<hex>");
+// The file is memory mapped rather than read
+Image read_hex_file(const std::string& path);
+
+// .sk28img: an image laid out the way the bootloader writes it, so a
+// production station converts its hex file once and flashes from that.
+// All fields are little endian.
+//
+//   Header, 32 bytes:  magic "SK28IMG\0", u16 version (1), u16 region count,
+//                      u32 row count, u32 data offset (a multiple of 64),
+//                      u16 row size (64), u16 CRC, 8 bytes of zeros
+//   Regions, 16 bytes: u8 RegionKind, 3 bytes of zeros, u32 first row,
+//                      u32 row count, u32 bytes the image has in the region
+//   Rows, 16 bytes:    u32 address (row aligned), u16 row CRC, 2 bytes of zeros,
+//                      u64 mask of the bytes the image has in the row
+//   Data:              64 bytes per row, 0xFF where the image has nothing
+//
+// A row is one erase row (kEraseRowSize), two ProgramBlockSize blocks.  Its
+// CRC is crc16_ccitt() over the 64 bytes, which is what VERIFY_RANGE reports
+// for the row once it has been erased and programmed.  The header CRC covers
+// everything before the data, with the CRC field itself zeroed.  Regions and
+// rows are in ascending address order.
+enum class RegionKind : uint8_t {
+    Program = 0x01,  // Same values as MemoryType, with the User ID kept apart
+    Eeprom = 0x02,
+    Config = 0x03,
+    UserId = 0x04,
+};
+
+RegionKind region_kind(uint32_t address);
+std::string to_string(RegionKind kind);
+
+std::vector<uint8_t> to_image_file(const Image& image);
+void write_image_file(const Image& image, const std::string& path);
+
+class MappedFile;
+
+// Memory mapped .sk28img, checked (header, CRCs, row order) when opened
+class ImageFile {
+public:
+    explicit ImageFile(const std::string& path);
+    ~ImageFile();
+    ImageFile(const ImageFile&) = delete;
+    ImageFile& operator=(const ImageFile&) = delete;
+
+    struct Region {
+        RegionKind kind;
+        uint32_t first_row;
+        uint32_t row_count;
+        uint32_t byte_count;
+    };
+    struct Row {
+        uint32_t address;
+        uint16_t crc;
+        uint64_t present;      // Bit n set if the image has bytes[n]
+        const uint8_t* bytes;  // 64 of them, in the mapping
+    };
+
+    const std::vector<Region>& regions() const { return regions_; }
+    size_t row_count() const { return row_count_; }
+    Row row(size_t i) const;
+    // The row at `address` (kEraseRowSize aligned), by binary search
+    std::optional<Row> find_row(uint32_t address) const;
+
+    // Maximal runs of the bytes the image has, copied out of the rows
+    Image to_image() const;
+
+private:
+    std::unique_ptr<const MappedFile> file_;
+    std::vector<Region> regions_;
+    size_t row_count_ = 0;
+    const uint8_t* rows_ = nullptr;
+    const uint8_t* row_data_ = nullptr;
+};
+
+bool is_image_file(const std::string& path);  // Starts with the .sk28img magic
+// An .sk28img or Intel HEX file, told apart by their content
+Image read_image(const std::string& path);
+
+// An .sk28img or Intel HEX file opened for flashing: an .sk28img stays mapped
+// and is flashed straight from the mapping, a hex file is parsed.
+class ImageSource {
+public:
+    explicit ImageSource(const std::string& path);
+    ImageSource(const ImageSource&) = delete;
+    ImageSource& operator=(const ImageSource&) = delete;
+
+    const ImageView& view() const { return view_; }
+
+private:
+    std::unique_ptr<const ImageFile> file_;
+    Image image_;
+    ImageView view_;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_IMAGE_H
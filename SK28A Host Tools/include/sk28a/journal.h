@@ -0,0 +1,65 @@
+// Progress journal for resumable flashing (see Flasher::flash(image, journal)).
+//
+// A text file the flasher appends to as it goes:
+//
+//   sk28a-journal 1 0123456789ABCDEF
+//   0x001400
+//   0x001800
+//
+// The first line names the image by its fingerprint().  Each address after
+// it says that everything the image has below that address, config words
+// aside, has been programmed and verified on the board.  Lines are only ever
+// added, so a run that dies halfway through writing one leaves the lines
+// before it standing.
+#ifndef SK28A_JOURNAL_H
+#define SK28A_JOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "sk28a/image.h"
+
+namespace sk28a {
+
+class JournalError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// FNV-1a over the addresses and bytes of the image.  The same for an Image
+// and a view of an .sk28img with the same bytes.
+uint64_t fingerprint(const ImageView& image);
+
+class Journal {
+public:
+    explicit Journal(std::string path) : path_(std::move(path)) {}
+    ~Journal();
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    // How far the journal has the image with this fingerprint programmed: 0
+    // if there is no journal, or it is for another image.
+    uint32_t load(uint64_t image_fingerprint) const;
+
+    // Replaces the journal with one for this image, programmed up to `done`,
+    // and keeps it open for commit().
+    void start(uint64_t image_fingerprint, uint32_t done = 0);
+    void commit(uint32_t done);
+
+    // Deletes the journal, once the board has the whole image
+    void remove();
+
+private:
+    void close();
+
+    std::string path_;
+    std::FILE* file_ = nullptr;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_JOURNAL_H
@@ -0,0 +1,52 @@
+// libusb link to a bootloader running the vendor class bulk transport (the
+// USB_USE_GEN build).  It has no hidraw node: the tool claims interface 0
+// and moves the same 64 byte packets over bulk endpoints 0x02 and 0x82.
+//
+// Only built when CMake finds libusb-1.0 (SK28A_HAVE_LIBUSB).
+#ifndef SK28A_LIBUSB_TRANSPORT_H
+#define SK28A_LIBUSB_TRANSPORT_H
+
+#include <string>
+#include <vector>
+
+#include "sk28a/transport.h"
+
+struct libusb_context;
+struct libusb_device_handle;
+
+namespace sk28a {
+
+constexpr uint8_t kVendorInterfaceClass = 0xFF;
+constexpr uint8_t kBulkOutEndpoint = 0x02;
+constexpr uint8_t kBulkInEndpoint = 0x82;
+
+struct LibusbDevice {
+    std::string path;  // usb:BUS-PORT[.PORT...], as LibusbTransport takes it
+    std::string phys;  // The same, stable for a given port
+    std::string uniq;  // Serial number string, empty if the device has none
+};
+
+// All devices matching vendor_id:product_id whose interface 0 is vendor
+// class, sorted by path.  The HID build of the bootloader is left to hidraw.
+std::vector<LibusbDevice> find_libusb_devices(uint16_t vendor_id = kVendorId, uint16_t product_id = kProductId);
+
+class LibusbTransport : public Transport {
+public:
+    explicit LibusbTransport(const std::string& path);
+    ~LibusbTransport() override;
+    LibusbTransport(const LibusbTransport&) = delete;
+    LibusbTransport& operator=(const LibusbTransport&) = delete;
+
+    void write(const Packet& packet) override;
+    bool read(Packet& packet, std::chrono::milliseconds timeout) override;
+    std::string description() const override { return path_; }
+
+private:
+    std::string path_;
+    libusb_context* context_ = nullptr;
+    libusb_device_handle* handle_ = nullptr;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_LIBUSB_TRANSPORT_H
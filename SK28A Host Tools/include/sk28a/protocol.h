@@ -0,0 +1,185 @@
+// Packet format of the SK28A HID bootloader (see ProcessIO() and PacketToFromPC
+// in "SK28A Bootloader Firmware/BootPIC18NonJ.c").
+//
+// Every command and response is one 64 byte report.  C18 packs structures
+// without padding and stores multi-byte fields little endian, so the field
+// offsets below follow directly from the firmware's union members.
+#ifndef SK28A_PROTOCOL_H
+#define SK28A_PROTOCOL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sk28a {
+
+// Device descriptor (usbdsc.c)
+constexpr uint16_t kVendorId = 0x04D8;
+constexpr uint16_t kProductId = 0x003C;
+
+constexpr size_t kPacketSize = 64;       // TotalPacketSize
+constexpr size_t kDataBlockSize = 58;    // RequestDataBlockSize
+constexpr size_t kEraseRowSize = 64;     // Flash erase granularity
+constexpr size_t kProgramBlockSize = 32; // ProgramBlockSize, flash write granularity
+
+enum class Command : uint8_t {
+    QueryDevice = 0x02,
+    UnlockConfig = 0x03,
+    EraseDevice = 0x04,
+    ProgramDevice = 0x05,
+    ProgramComplete = 0x06,
+    GetData = 0x07,
+    ResetDevice = 0x08,
+    // Optional extensions, see "ExtendedFeatures" below
+    ReadStream = 0x10,
+    VerifyRange = 0x11,
+    EraseRange = 0x12,
+    ProgramCompressed = 0x13,
+    Fill = 0x14,
+    PatchDevice = 0x15,
+    GetEraseStatus = 0x16,
+};
+
+enum class MemoryType : uint8_t {
+    Program = 0x01,  // Also reported for the User ID
+    Eeprom = 0x02,
+    Config = 0x03,
+    EndOfList = 0xFF,
+};
+
+// QUERY_DEVICE "ExtendedFeatures" bits, one per USE_xxx option compiled into
+// the firmware.  A stock build reports 0.
+namespace feature {
+constexpr uint16_t kReadStream = 0x0001;
+constexpr uint16_t kVerifyRange = 0x0002;
+constexpr uint16_t kEraseRange = 0x0004;
+constexpr uint16_t kBlankCheckErase = 0x0008;
+constexpr uint16_t kCompressedProgramming = 0x0010;
+constexpr uint16_t kFill = 0x0020;
+constexpr uint16_t kAutoSectionProgramming = 0x0040;
+constexpr uint16_t kPatch = 0x0080;
+constexpr uint16_t kBackgroundErase = 0x0100;
+constexpr uint16_t kLazyErase = 0x0200;
+}  // namespace feature
+
+// ERASE_RANGE "RangeFlags"
+constexpr uint8_t kEraseRangeEeprom = 0x01;
+constexpr uint8_t kEraseRangeUserId = 0x02;
+
+// GET_ERASE_STATUS "StatusFlags"
+constexpr uint8_t kStatusEraseBusy = 0x01;
+
+// UNLOCK_CONFIG "LockValue"
+constexpr uint8_t kUnlockConfig = 0x00;
+constexpr uint8_t kLockConfig = 0x01;
+
+// Byte offsets of the fields shared by several commands
+namespace offset {
+constexpr size_t kCommand = 0;
+constexpr size_t kAddress = 1;       // u32, all addressed commands
+constexpr size_t kSize = 5;          // u8, PROGRAM_DEVICE/GET_DATA family
+constexpr size_t kData = 6;          // Data[58], right justified
+constexpr size_t kLength = 5;        // u32, range commands
+constexpr size_t kRangeFlags = 9;    // u8, ERASE_RANGE
+constexpr size_t kChecksum = 10;     // u16, VERIFY_RANGE response
+constexpr size_t kErasedPages = 12;  // u16, ERASE_RANGE response
+constexpr size_t kFillValue = 14;    // u8, FILL
+constexpr size_t kLockValue = 1;     // u8, UNLOCK_CONFIG
+}  // namespace offset
+
+class ProtocolError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct Packet {
+    std::array<uint8_t, kPacketSize> bytes{};
+
+    Command command() const { return static_cast<Command>(bytes[offset::kCommand]); }
+    uint8_t u8(size_t at) const { return bytes[at]; }
+    uint16_t u16(size_t at) const;
+    uint32_t u32(size_t at) const;
+    void set_u8(size_t at, uint8_t v) { bytes[at] = v; }
+    void set_u16(size_t at, uint16_t v);
+    void set_u32(size_t at, uint32_t v);
+
+    uint32_t address() const { return u32(offset::kAddress); }
+    uint8_t size() const { return bytes[offset::kSize]; }
+    // Payload of a PROGRAM_DEVICE/GET_DATA/READ_STREAM packet: the last size() bytes of Data[]
+    const uint8_t* payload() const { return bytes.data() + offset::kData + kDataBlockSize - size(); }
+};
+
+Packet make_command(Command command);
+Packet make_data_packet(Command command, uint32_t address, const uint8_t* data, size_t size);  // PROGRAM_DEVICE
+Packet make_get_data(uint32_t address, uint8_t size);
+Packet make_range(Command command, uint32_t address, uint32_t length);  // READ_STREAM, VERIFY_RANGE, ERASE_RANGE
+Packet make_unlock_config(bool unlock);
+
+// PROGRAM_COMPRESSED payload (see ExpandCompressedPacket() in the firmware):
+// PackBits-encodes `data` into `out` until the next run would take it past
+// `max_size` bytes, and returns how many bytes of `data` that took.  The
+// stream always ends on a run boundary, as each packet has to stand alone.
+size_t packbits_encode(const uint8_t* data, size_t size, size_t max_size, std::vector<uint8_t>& out);
+
+struct MemoryRegion {
+    MemoryType type;
+    uint32_t address;
+    uint32_t length;
+
+    uint32_t end() const { return address + length; }
+    bool contains(uint32_t a) const { return a >= address && a < end(); }
+};
+
+struct DeviceInfo {
+    uint8_t packet_data_field_size = 0;
+    uint8_t bytes_per_address = 0;
+    std::vector<MemoryRegion> regions;
+    uint16_t extended_features = 0;
+
+    bool has(uint16_t feature_bit) const { return (extended_features & feature_bit) != 0; }
+    const MemoryRegion* region_at(uint32_t address) const;
+};
+
+DeviceInfo parse_query_response(const Packet& response);
+
+struct EraseStatus {
+    bool busy = false;
+    uint16_t pages_done = 0;
+    uint16_t pages_remaining = 0;
+    uint16_t pages_erased = 0;
+};
+
+EraseStatus parse_status_response(const Packet& response);
+
+// The PIC18 memory map conventions the host needs to know about
+inline bool is_config_address(uint32_t a) { return (a >> 16) == 0x30; }
+inline bool is_eeprom_address(uint32_t a) { return (a >> 16) == 0xF0; }
+inline bool is_user_id_address(uint32_t a) { return (a >> 16) == 0x20; }
+
+// The User ID, which a USE_SERIAL_NUMBER_STRING build reports as its USB
+// serial number: the 8 bytes as 16 hex digits, in address order
+constexpr uint32_t kUserIdAddress = 0x200000;
+constexpr size_t kUserIdSize = 8;
+using UserId = std::array<uint8_t, kUserIdSize>;
+
+// Up to 16 hex digits, right aligned.  False if it isn't that.
+bool parse_serial_number(const std::string& text, UserId& id);
+std::string serial_number(const UserId& id);
+// The serial number after this one, wrapping around
+UserId next_serial_number(UserId id);
+
+// VERIFY_RANGE checksum: CRC-16/CCITT-FALSE
+uint16_t crc16_ccitt(const uint8_t* data, size_t size, uint16_t crc = 0xFFFF);
+// The CRC of A followed by B, from crc16_ccitt() of each and the size of B,
+// without going over the bytes again
+uint16_t crc16_ccitt_combine(uint16_t crc_a, uint16_t crc_b, size_t size_b);
+
+std::string to_string(Command command);
+std::string to_string(MemoryType type);
+
+}  // namespace sk28a
+
+#endif  // SK28A_PROTOCOL_H
@@ -0,0 +1,59 @@
+// Protocol-level stand-in for a PIC18F2550 running the stock bootloader, so
+// the flasher can be exercised and benchmarked without a board attached.
+//
+// It follows the rules of the firmware that matter to a host: PROGRAM_DEVICE
+// packets are dropped unless they continue the current section (or follow a
+// PROGRAM_COMPLETE), programming can only clear bits, the bootloader block is
+// write protected, and the config words need UNLOCK_CONFIG first.
+#ifndef SK28A_SIM_DEVICE_H
+#define SK28A_SIM_DEVICE_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "sk28a/transport.h"
+
+namespace sk28a {
+
+class SimDevice : public Transport {
+public:
+    // PIC18F2550 memory map, as reported by QUERY_DEVICE
+    static constexpr uint32_t kProgramStart = 0x001000;
+    static constexpr uint32_t kProgramEnd = 0x008000;
+    static constexpr uint32_t kUserIdAddress = 0x200000;
+    static constexpr uint32_t kUserIdSize = 8;
+    static constexpr uint32_t kConfigAddress = 0x300000;
+    static constexpr uint32_t kConfigSize = 14;
+    static constexpr uint32_t kEepromAddress = 0xF00000;
+    static constexpr uint32_t kEepromSize = 0x100;
+
+    SimDevice();
+
+    void write(const Packet& packet) override;
+    bool read(Packet& packet, std::chrono::milliseconds timeout) override;
+    std::string description() const override { return "simulated PIC18F2550"; }
+
+    uint8_t peek(uint32_t address) const;
+    void poke(uint32_t address, uint8_t value);  // Bypasses the flash rules, for setting up a scenario
+    unsigned reset_count() const { return reset_count_; }
+
+private:
+    uint8_t* locate(uint32_t address);
+    void program(uint32_t address, const uint8_t* data, size_t size);
+    void erase_device();
+    void respond(const Packet& packet) { responses_.push_back(packet); }
+
+    std::vector<uint8_t> flash_;
+    std::vector<uint8_t> user_id_;
+    std::vector<uint8_t> config_;
+    std::vector<uint8_t> eeprom_;
+    std::deque<Packet> responses_;
+    uint32_t programmed_pointer_;
+    bool configs_locked_ = true;
+    unsigned reset_count_ = 0;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_SIM_DEVICE_H
@@ -0,0 +1,45 @@
+// Report-level link to one bootloader.
+#ifndef SK28A_TRANSPORT_H
+#define SK28A_TRANSPORT_H
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "sk28a/protocol.h"
+
+namespace sk28a {
+
+class TransportError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct TransportStats {
+    uint64_t reports_written = 0;
+    uint64_t reports_read = 0;
+};
+
+// Writes are not acknowledged by the protocol, so a transport only has to
+// hand reports over in order.  Several of them may be outstanding at once;
+// the device pushes back by NAKing its OUT endpoint, which shows up here as
+// write() blocking.  Responses come back in the order the commands were sent.
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual void write(const Packet& packet) = 0;
+    // Returns false if nothing arrived within the timeout.
+    virtual bool read(Packet& packet, std::chrono::milliseconds timeout) = 0;
+    virtual std::string description() const = 0;
+
+    const TransportStats& stats() const { return stats_; }
+
+protected:
+    TransportStats stats_;
+};
+
+}  // namespace sk28a
+
+#endif  // SK28A_TRANSPORT_H
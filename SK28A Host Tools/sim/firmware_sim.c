@@ -0,0 +1,402 @@
+#include "firmware_sim.h"
+
+#include <setjmp.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pic18_model.h"
+
+#include <p18cxxx.h>
+#include "typedefs.h"
+#include "usb.h"
+#include "BootPIC18NonJ.h"
+
+#define STEP_LIMIT          100000ul    /* Main loop passes a bus operation waits for the firmware */
+#define USTAT_FIFO_DEPTH    4           /* As on the part */
+#define PASS_CYCLES         150         /* Estimated cost of a main loop pass with nothing much to do */
+#define FRAME_CYCLES        PIC18_CYCLES_PER_MS
+#define BULK_PER_FRAME      19          /* Most 64 byte bulk transactions a full speed frame has room for */
+
+static jmp_buf reset_point;
+static unsigned long reset_count;
+
+static byte ustat_fifo[USTAT_FIFO_DEPTH];
+static byte ustat_count;
+static byte ppbi_out;                   /* Next even (0) or odd (1) BD of the data endpoint */
+static byte ppbi_in;
+
+/* Bus time, in the model's instruction cycles.  The data endpoint gets one
+   transaction (taken or NAKed) per period: its polling interval for an
+   interrupt endpoint, a share of the frame for a bulk one. */
+static unsigned long data_period;
+static uint64_t pass_start;             /* Clock when the last main loop pass began */
+static uint64_t next_out_slot;
+static uint64_t next_in_slot;
+
+/* SIE: transaction complete.  USTAT only advances once the firmware has cleared TRNIF. */
+static void sie_update(void)
+{
+    if(UIRbits.TRNIF || ustat_count == 0)
+        return;
+    USTAT = ustat_fifo[0];
+    memmove(ustat_fifo, ustat_fifo + 1, --ustat_count);
+    UIRbits.TRNIF = 1;
+}
+
+static void sie_post(byte ep, byte dir, byte odd)
+{
+    if(ustat_count < USTAT_FIFO_DEPTH)
+        ustat_fifo[ustat_count++] = (byte)((ep << 3) | (dir << 2) | (odd << 1));
+    sie_update();
+}
+
+static void sie_ppbrst(void)
+{
+    ppbi_out = 0;
+    ppbi_in = 0;
+}
+
+static void sie_bus_reset(void)
+{
+    ustat_count = 0;
+    sie_ppbrst();
+    next_out_slot = 0;
+    next_in_slot = 0;
+    UIRbits.URSTIF = 1;
+}
+
+static int ping_pong(void)
+{
+    return (UCFG & 0x03) == _PPBM3;
+}
+
+static volatile BDT* bd(byte ep, byte dir, byte odd)
+{
+    unsigned i;
+
+    if(ep == 0)
+        i = dir;
+    else if(ping_pong())
+        i = 2 + (ep - 1) * 4 + dir * 2 + odd;
+    else
+        i = ep * 2 + dir;
+    return i < USB_BDT_ENTRIES ? &usb_bdt[i] : NULL;
+}
+
+/* The interrupt endpoint (HID) or bulk endpoint (USB_USE_GEN) the firmware enabled, 0 if none yet */
+static byte data_endpoint(void)
+{
+    byte ep;
+
+    for(ep = 1; ep < 16; ep++)
+    {
+        if((pic18_sfr.uep[ep].v & (EP_OUT_IN & ~EP_CTRL)) && (pic18_sfr.uep[ep].v & EP_CTRL) == EP_CTRL)
+            return ep;
+    }
+    return 0;
+}
+
+/* Takes the endpoint's next transaction slot if it has come round.  Slots that
+   went by while the firmware was stalled in the last pass (a flash write, say)
+   can still be used: the SIE works on regardless of the CPU. */
+static int take_slot(uint64_t* next_slot)
+{
+    uint64_t slot = *next_slot > pass_start ? *next_slot : pass_start;
+
+    if(slot > pic18_cycles())
+        return 0;
+    *next_slot = slot + data_period;
+    return 1;
+}
+
+/* Polling period of the data endpoint, from its descriptor in the configuration descriptor */
+static void read_data_period(const uint8_t* cfg, unsigned length)
+{
+    unsigned i;
+
+    data_period = FRAME_CYCLES;
+    for(i = 0; i + 7 <= length && cfg[i] != 0; i += cfg[i])
+    {
+        if(cfg[i + 1] != DSC_EP)
+            continue;
+        if((cfg[i + 3] & 0x03) == _BULK)
+            data_period = FRAME_CYCLES / BULK_PER_FRAME;
+        else if(cfg[i + 6] != 0)
+            data_period = cfg[i + 6] * FRAME_CYCLES;
+        return;
+    }
+}
+
+/* BootHighISR() in main.c: USBIF is raised by any enabled USB interrupt flag */
+static void usb_interrupt(void)
+{
+#if defined(USB_INTERRUPT)
+    if((UIR & UIE) || (UEIR & UEIE))
+        PIR2bits.USBIF = 1;
+    if(INTCONbits.GIE && INTCONbits.PEIE && PIE2bits.USBIE && PIR2bits.USBIF)
+    {
+        PIR2bits.USBIF = 0;
+        USBDriverService();
+    }
+#endif
+}
+
+/* InitializeSystem() in main.c */
+static void start_firmware(void)
+{
+    pic18_model_reset_registers();
+    ustat_count = 0;
+    sie_ppbrst();
+
+    mInitializeUSBDriver();
+    UserInit();
+#if defined(USB_INTERRUPT)
+    PIR2bits.USBIF = 0;
+    PIE2bits.USBIE = 1;
+    INTCONbits.PEIE = 1;
+    INTCONbits.GIE = 1;
+#endif
+}
+
+static void on_reset(void)
+{
+    longjmp(reset_point, 1);
+}
+
+void fwsim_step(void)
+{
+    if(setjmp(reset_point))
+    {
+        /* Reset() from the firmware.  The board comes back up in the bootloader. */
+        reset_count++;
+        start_firmware();
+        return;
+    }
+
+    pass_start = pic18_cycles();
+    pic18_delay_cycles(PASS_CYCLES);
+    sie_update();
+    usb_interrupt();
+    USBCheckBusStatus();
+    mUSBDriverServicePoll();
+    usb_interrupt();
+    if((usb_device_state == CONFIGURED_STATE) && (UCONbits.SUSPND != 1))
+        ProcessIO();
+}
+
+static int run_until(int (*condition)(void))
+{
+    unsigned long n;
+
+    for(n = 0; n < STEP_LIMIT; n++)
+    {
+        if(condition())
+            return 1;
+        fwsim_step();
+    }
+    return condition();
+}
+
+static int powered(void) { return usb_device_state >= POWERED_STATE; }
+static int default_state(void) { return usb_device_state == DEFAULT_STATE; }
+static int addressed(void) { return usb_device_state == ADDRESS_STATE; }
+static int setup_ready(void) { return ep0Bo.Stat.UOWN && !UCONbits.PKTDIS; }
+static int ep0_out_ready(void) { return ep0Bo.Stat.UOWN; }
+static int ep0_in_ready(void) { return ep0Bi.Stat.UOWN; }
+static int transactions_done(void) { return !UIRbits.TRNIF && ustat_count == 0; }
+
+int fwsim_configured(void)
+{
+    return usb_device_state == CONFIGURED_STATE;
+}
+
+unsigned long fwsim_reset_count(void)
+{
+    return reset_count;
+}
+
+uint64_t fwsim_cycles(void)
+{
+    return pic18_cycles();
+}
+
+static int stalled(volatile BDT* b)
+{
+    if(!b->Stat.BSTALL)
+        return 0;
+    UEP0bits.EPSTALL = 1;
+    UIRbits.STALLIF = 1;
+    return 1;
+}
+
+int fwsim_control_in(const uint8_t setup[8], uint8_t* data, unsigned length)
+{
+    unsigned requested = setup[6] | (setup[7] << 8);
+    unsigned received = 0;
+    unsigned n;
+    byte count;
+
+    if(requested < length)
+        length = requested;
+
+    /* Setup stage.  EP0 OUT takes a SETUP even when it is armed with BSTALL. */
+    if(!run_until(setup_ready))
+        return -1;
+    memcpy(ep0Bo.ADR, setup, 8);
+    ep0Bo.Cnt = 8;
+    ep0Bo.Stat._byte = SETUP_TOKEN << 2;
+    UCONbits.PKTDIS = 1;                /* Held until the firmware has looked at the request */
+    sie_post(0, OUT, 0);
+
+    if(setup[0] & 0x80)
+    {
+        /* Data stage (IN), until a short packet or everything asked for */
+        for(;;)
+        {
+            if(!run_until(ep0_in_ready))
+                return -1;
+            if(stalled(&ep0Bi))
+                return -1;
+            count = ep0Bi.Cnt;
+            n = count < length - received ? count : length - received;
+            memcpy(data + received, ep0Bi.ADR, n);
+            received += n;
+            ep0Bi.Stat._byte = (ep0Bi.Stat._byte & _DTSMASK) | (IN_TOKEN << 2);
+            sie_post(0, IN, 0);
+            if(count < EP0_BUFF_SIZE || received >= requested)
+                break;
+        }
+        /* Status stage, zero length OUT */
+        if(!run_until(ep0_out_ready))
+            return -1;
+        if(stalled(&ep0Bo))
+            return -1;
+        ep0Bo.Cnt = 0;
+        ep0Bo.Stat._byte = (ep0Bo.Stat._byte & _DTSMASK) | (OUT_TOKEN << 2);
+        sie_post(0, OUT, 0);
+    }
+    else
+    {
+        /* Status stage, zero length IN */
+        if(!run_until(ep0_in_ready))
+            return -1;
+        if(stalled(&ep0Bi))
+            return -1;
+        ep0Bi.Stat._byte = (ep0Bi.Stat._byte & _DTSMASK) | (IN_TOKEN << 2);
+        sie_post(0, IN, 0);
+    }
+    if(!run_until(transactions_done))
+        return -1;
+    return (int)received;
+}
+
+int fwsim_enumerate(void)
+{
+    static const uint8_t get_device_dsc[8] = {0x80, GET_DSC, 0, DSC_DEV, 0, 0, sizeof(USB_DEV_DSC), 0};
+    static const uint8_t set_address[8] = {0x00, SET_ADR, 1, 0, 0, 0, 0, 0};
+    static const uint8_t set_configuration[8] = {0x00, SET_CFG, 1, 0, 0, 0, 0, 0};
+#if defined(USB_USE_HID)
+    static const uint8_t set_idle[8] = {0x21, SET_IDLE, 0, 0, 0, 0, 0, 0};
+#endif
+    uint8_t setup[8] = {0x80, GET_DSC, 0, DSC_CFG, 0, 0, 0, 0};
+    uint8_t dsc[255];
+    unsigned total;
+
+    if(!run_until(powered))
+        return -1;
+    sie_bus_reset();
+    if(!run_until(default_state))
+        return -1;
+
+    if(fwsim_control_in(get_device_dsc, dsc, sizeof(USB_DEV_DSC)) != sizeof(USB_DEV_DSC))
+        return -1;
+    if(fwsim_control_in(set_address, NULL, 0) != 0 || !run_until(addressed))
+        return -1;
+
+    setup[6] = sizeof(USB_CFG_DSC);
+    if(fwsim_control_in(setup, dsc, sizeof(USB_CFG_DSC)) != sizeof(USB_CFG_DSC))
+        return -1;
+    total = dsc[2] | (dsc[3] << 8);
+    if(total > sizeof dsc)
+        return -1;
+    setup[6] = (uint8_t)total;
+    if(fwsim_control_in(setup, dsc, total) != (int)total)
+        return -1;
+    read_data_period(dsc, total);
+
+    if(fwsim_control_in(set_configuration, NULL, 0) != 0 || !run_until(fwsim_configured))
+        return -1;
+
+#if defined(USB_USE_HID)
+    /* What the host's HID driver does next.  A stalled SET_IDLE is allowed.
+       The vendor class build (USB_USE_GEN) has no class driver, so nothing more happens. */
+    if(dsc[sizeof(USB_CFG_DSC) + 5] == HID_INTF)
+    {
+        int n;
+
+        fwsim_control_in(set_idle, NULL, 0);
+        setup[0] = 0x81;                /* Standard request to the interface */
+        setup[3] = DSC_RPT;
+        setup[6] = dsc[sizeof(USB_CFG_DSC) + sizeof(USB_INTF_DSC) + 7];
+        setup[7] = dsc[sizeof(USB_CFG_DSC) + sizeof(USB_INTF_DSC) + 8];
+        n = setup[6] | (setup[7] << 8);
+        if(n > (int)sizeof dsc || fwsim_control_in(setup, dsc, (unsigned)n) != n)
+            return -1;
+    }
+#endif
+    return 0;
+}
+
+int fwsim_power_on(void)
+{
+    pic18_set_reset_handler(on_reset);
+    pic18_set_ppbrst_handler(sie_ppbrst);
+    pic18_model_power_on();
+    pass_start = 0;
+    start_firmware();
+    reset_count = 0;
+    return fwsim_enumerate();
+}
+
+int fwsim_out(const uint8_t* report, unsigned length)
+{
+    byte ep = data_endpoint();
+    volatile BDT* b;
+
+    if(ep == 0 || !fwsim_configured())
+        return 0;
+    if(!take_slot(&next_out_slot))
+        return -1;
+    b = bd(ep, OUT, ppbi_out);
+    if(b == NULL || !b->Stat.UOWN || b->Stat.BSTALL || length > b->Cnt)
+        return 0;
+    memcpy(b->ADR, report, length);
+    b->Cnt = (byte)length;
+    b->Stat._byte = (b->Stat._byte & _DTSMASK) | (OUT_TOKEN << 2);
+    sie_post(ep, OUT, ppbi_out);
+    if(ping_pong())
+        ppbi_out ^= 1;
+    return 1;
+}
+
+int fwsim_in(uint8_t* report)
+{
+    byte ep = data_endpoint();
+    volatile BDT* b;
+    byte count;
+
+    if(ep == 0 || !fwsim_configured() || !take_slot(&next_in_slot))
+        return -1;
+    b = bd(ep, IN, ppbi_in);
+    if(b == NULL || !b->Stat.UOWN)
+        return -1;
+    count = b->Cnt;
+    if(count > FWSIM_REPORT_SIZE)
+        count = FWSIM_REPORT_SIZE;
+    memcpy(report, b->ADR, count);
+    b->Stat._byte = (b->Stat._byte & _DTSMASK) | (IN_TOKEN << 2);
+    sie_post(ep, IN, ppbi_in);
+    if(ping_pong())
+        ppbi_in ^= 1;
+    return count;
+}
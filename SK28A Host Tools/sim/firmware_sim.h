@@ -0,0 +1,59 @@
+/*
+ * The bootloader firmware itself (BootPIC18NonJ.c and the USB stack),
+ * compiled for the host and run against pic18_model.c, with a model of the
+ * USB SIE and of the host's side of the bus in place of the hardware.
+ *
+ * fwsim_step() is one pass of the firmware's main loop (see main.c, which
+ * is not part of the host build).  The bus is only touched between passes:
+ * an OUT report lands in the data endpoint's buffer if the firmware has
+ * armed it (otherwise the endpoint NAKs), and an IN report is picked up once
+ * the firmware has handed its buffer to the SIE.
+ *
+ * Time runs on the model's virtual clock (pic18_cycles()).  A pass charges a
+ * fixed estimate of the CPU time it takes, on top of what the model charges
+ * for flash and EEPROM writes, and the data endpoint only gets one
+ * transaction per polling interval (1 ms for the HID interrupt endpoints).
+ *
+ * There is one device per process: the firmware keeps its state in globals.
+ */
+#ifndef FIRMWARE_SIM_H
+#define FIRMWARE_SIM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FWSIM_REPORT_SIZE 64
+
+/* Fresh part (pic18_model_power_on()), firmware started, enumerated.  0 on success. */
+int fwsim_power_on(void);
+/* Bus reset and enumeration, as the host does after the device (re)connects.  0 on success. */
+int fwsim_enumerate(void);
+/* The firmware has accepted SET_CONFIGURATION and hasn't reset since */
+int fwsim_configured(void);
+
+/* One pass of the main loop */
+void fwsim_step(void);
+
+/* Offers an OUT report to the data endpoint.  1 if the SIE took it, 0 if it was NAKed,
+   -1 if the endpoint's next polling interval hasn't come yet (step and try again). */
+int fwsim_out(const uint8_t* report, unsigned length);
+/* Collects an IN report from the data endpoint.  Its length, or -1 if none was ready (NAK)
+   or the endpoint's next polling interval hasn't come yet. */
+int fwsim_in(uint8_t* report);
+
+/* Control transfer on EP0 with an IN or no data stage.  Bytes received, or -1 if the device stalled. */
+int fwsim_control_in(const uint8_t setup[8], uint8_t* data, unsigned length);
+
+/* Times the firmware executed RESET_DEVICE (or otherwise reset itself) */
+unsigned long fwsim_reset_count(void);
+/* Virtual time since fwsim_power_on(), in instruction cycles (PIC18_CYCLES_PER_MS per ms) */
+uint64_t fwsim_cycles(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FIRMWARE_SIM_H */
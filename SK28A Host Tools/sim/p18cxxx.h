@@ -0,0 +1,193 @@
+/*
+ * Host stand-in for C18's <p18cxxx.h>, for building the bootloader firmware
+ * with gcc/clang (see firmware_sim.h).  It is found ahead of the real header
+ * through the include path, so the firmware sources are compiled unmodified
+ * apart from their __18CXX branches.
+ *
+ * The special function registers the firmware uses are plain memory here.
+ * The operations that have side effects on the part (table reads/writes, the
+ * EECON2 unlock sequence, EEPROM reads, UCONbits.PPBRST, Reset()) call into
+ * pic18_model.c.
+ *
+ * Include system headers before this one: it ends by switching to packed
+ * structs, which C18 always uses and the firmware's packets and USB
+ * descriptors depend on.
+ */
+#ifndef PIC18_HOST_P18CXXX_H
+#define PIC18_HOST_P18CXXX_H
+
+#include <stdint.h>
+
+#if !defined(__18F2550)
+#error The host build only models the PIC18F2550.  Define __18F2550.
+#endif
+
+/* C18 storage qualifiers */
+#define rom     const
+#define ram
+#define far
+#define near
+
+/* Single bit views of the registers, named as in C18's p18f2550.h */
+typedef union {
+    struct { unsigned char :1, SUSPND:1, RESUME:1, USBEN:1, PKTDIS:1, SE0:1, PPBRST:1, :1; };
+} PIC18_UCONbits;
+typedef union {
+    struct { unsigned char URSTIF:1, UERRIF:1, ACTVIF:1, TRNIF:1, IDLEIF:1, STALLIF:1, SOFIF:1, :1; };
+} PIC18_UIRbits;
+typedef union {
+    struct { unsigned char URSTIE:1, UERRIE:1, ACTVIE:1, TRNIE:1, IDLEIE:1, STALLIE:1, SOFIE:1, :1; };
+} PIC18_UIEbits;
+typedef union {
+    struct { unsigned char EPSTALL:1, EPINEN:1, EPOUTEN:1, EPCONDIS:1, EPHSHK:1, :3; };
+} PIC18_UEPbits;
+typedef union {
+    struct { unsigned char RD:1, WR:1, WREN:1, WRERR:1, FREE:1, :1, CFGS:1, EEPGD:1; };
+} PIC18_EECON1bits;
+typedef union {
+    struct { unsigned char RBIF:1, INT0IF:1, TMR0IF:1, RBIE:1, INT0IE:1, TMR0IE:1, PEIE:1, GIE:1; };
+} PIC18_INTCONbits;
+typedef union {
+    struct { unsigned char CCP2IF:1, TMR3IF:1, HLVDIF:1, BCLIF:1, EEIF:1, USBIF:1, CMIF:1, OSCFIF:1; };
+} PIC18_PIR2bits;
+typedef union {
+    struct { unsigned char CCP2IE:1, TMR3IE:1, HLVDIE:1, BCLIE:1, EEIE:1, USBIE:1, CMIE:1, OSCFIE:1; };
+} PIC18_PIE2bits;
+typedef union {
+    struct { unsigned char RA0:1, RA1:1, RA2:1, RA3:1, RA4:1, RA5:1, RA6:1, :1; };
+    struct { unsigned char TRISA0:1, TRISA1:1, TRISA2:1, TRISA3:1, TRISA4:1, TRISA5:1, TRISA6:1, :1; };
+    struct { unsigned char LATA0:1, LATA1:1, LATA2:1, LATA3:1, LATA4:1, LATA5:1, LATA6:1, :1; };
+} PIC18_PORTAbits;
+typedef union {
+    struct { unsigned char RB0:1, RB1:1, RB2:1, RB3:1, RB4:1, RB5:1, RB6:1, RB7:1; };
+    struct { unsigned char TRISB0:1, TRISB1:1, TRISB2:1, TRISB3:1, TRISB4:1, TRISB5:1, TRISB6:1, TRISB7:1; };
+    struct { unsigned char LATB0:1, LATB1:1, LATB2:1, LATB3:1, LATB4:1, LATB5:1, LATB6:1, LATB7:1; };
+} PIC18_PORTBbits;
+typedef union {
+    struct { unsigned char RC0:1, RC1:1, RC2:1, RC3:1, RC4:1, RC5:1, RC6:1, RC7:1; };
+    struct { unsigned char TRISC0:1, TRISC1:1, TRISC2:1, TRISC3:1, TRISC4:1, TRISC5:1, TRISC6:1, TRISC7:1; };
+    struct { unsigned char LATC0:1, LATC1:1, LATC2:1, LATC3:1, LATC4:1, LATC5:1, LATC6:1, LATC7:1; };
+} PIC18_PORTCbits;
+
+#define PIC18_SFR(bits_type) union { unsigned char v; bits_type bits; }
+
+/* The register file.  Only what the firmware and the model touch. */
+typedef struct {
+    PIC18_SFR(PIC18_UCONbits) ucon;
+    unsigned char ucfg;
+    PIC18_SFR(PIC18_UIRbits) uir;
+    PIC18_SFR(PIC18_UIEbits) uie;
+    unsigned char ueir;
+    unsigned char ueie;
+    unsigned char ustat;
+    unsigned char uaddr;
+    PIC18_SFR(PIC18_UEPbits) uep[16];    /* Contiguous, ClearArray() clears UEP1-UEP15 in one go */
+    union {
+        struct { unsigned char l, h, u; } b;
+        uint32_t ptr : 24;
+    } tblptr;
+    unsigned char tablat;
+    PIC18_SFR(PIC18_EECON1bits) eecon1;
+    unsigned char eecon2;
+    unsigned char eeadr;
+    unsigned char eedata;
+    PIC18_SFR(PIC18_INTCONbits) intcon;
+    PIC18_SFR(PIC18_PIR2bits) pir2;
+    PIC18_SFR(PIC18_PIE2bits) pie2;
+    PIC18_SFR(PIC18_PORTAbits) porta, trisa, lata;
+    PIC18_SFR(PIC18_PORTBbits) portb, trisb, latb;
+    PIC18_SFR(PIC18_PORTCbits) portc, trisc, latc;
+    unsigned char adcon1;
+    unsigned char wreg;
+} PIC18_SFRS;
+
+extern volatile PIC18_SFRS pic18_sfr;
+
+#define UCON        pic18_sfr.ucon.v
+#define UCONbits    (*pic18_uconbits()) /* Carries out a PPBRST left set by the last access */
+#define UCFG        pic18_sfr.ucfg
+#define UIR         pic18_sfr.uir.v
+#define UIRbits     pic18_sfr.uir.bits
+#define UIE         pic18_sfr.uie.v
+#define UIEbits     pic18_sfr.uie.bits
+#define UEIR        pic18_sfr.ueir
+#define UEIE        pic18_sfr.ueie
+#define USTAT       pic18_sfr.ustat
+#define UADDR       pic18_sfr.uaddr
+#define UEP0        pic18_sfr.uep[0].v
+#define UEP0bits    pic18_sfr.uep[0].bits
+#define UEP1        pic18_sfr.uep[1].v
+#define UEP2        pic18_sfr.uep[2].v
+#define UEP3        pic18_sfr.uep[3].v
+#define UEP4        pic18_sfr.uep[4].v
+#define UEP5        pic18_sfr.uep[5].v
+#define UEP6        pic18_sfr.uep[6].v
+#define UEP7        pic18_sfr.uep[7].v
+#define UEP8        pic18_sfr.uep[8].v
+#define UEP9        pic18_sfr.uep[9].v
+#define UEP10       pic18_sfr.uep[10].v
+#define UEP11       pic18_sfr.uep[11].v
+#define UEP12       pic18_sfr.uep[12].v
+#define UEP13       pic18_sfr.uep[13].v
+#define UEP14       pic18_sfr.uep[14].v
+#define UEP15       pic18_sfr.uep[15].v
+#define TBLPTR      pic18_sfr.tblptr.ptr
+#define TBLPTRL     pic18_sfr.tblptr.b.l
+#define TBLPTRH     pic18_sfr.tblptr.b.h
+#define TBLPTRU     pic18_sfr.tblptr.b.u
+#define TABLAT      pic18_sfr.tablat
+#define EECON1      pic18_sfr.eecon1.v
+#define EECON1bits  pic18_sfr.eecon1.bits
+#define EECON2      pic18_sfr.eecon2
+#define EEADR       (*pic18_eeadr())    /* Both complete an EECON1bits.RD = 1 first, which on the part */
+#define EEDATA      (*pic18_eedata())   /* latches the byte at once */
+#define INTCON      pic18_sfr.intcon.v
+#define INTCONbits  pic18_sfr.intcon.bits
+#define PIR2        pic18_sfr.pir2.v
+#define PIR2bits    pic18_sfr.pir2.bits
+#define PIE2        pic18_sfr.pie2.v
+#define PIE2bits    pic18_sfr.pie2.bits
+#define PORTA       pic18_sfr.porta.v
+#define PORTAbits   pic18_sfr.porta.bits
+#define PORTB       pic18_sfr.portb.v
+#define PORTBbits   pic18_sfr.portb.bits
+#define PORTC       pic18_sfr.portc.v
+#define PORTCbits   pic18_sfr.portc.bits
+#define TRISA       pic18_sfr.trisa.v
+#define TRISAbits   pic18_sfr.trisa.bits
+#define TRISB       pic18_sfr.trisb.v
+#define TRISBbits   pic18_sfr.trisb.bits
+#define TRISC       pic18_sfr.trisc.v
+#define TRISCbits   pic18_sfr.trisc.bits
+#define LATA        pic18_sfr.lata.v
+#define LATAbits    pic18_sfr.lata.bits
+#define LATB        pic18_sfr.latb.v
+#define LATBbits    pic18_sfr.latb.bits
+#define LATC        pic18_sfr.latc.v
+#define LATCbits    pic18_sfr.latc.bits
+#define ADCON1      pic18_sfr.adcon1
+#define WREG        pic18_sfr.wreg
+
+/* Model hooks, see pic18_model.c */
+volatile unsigned char* pic18_eeadr(void);
+volatile unsigned char* pic18_eedata(void);
+volatile PIC18_UCONbits* pic18_uconbits(void);
+void pic18_table_read(int step);        /* TABLAT = [TBLPTR], then TBLPTR += step */
+void pic18_table_write(int step);       /* Holding register at TBLPTR = TABLAT, then TBLPTR += step */
+void pic18_activate_write(void);        /* EECON1bits.WR = 1 after the 0x55/0xAA unlock sequence */
+void pic18_reset(void);                 /* Reset instruction, does not return */
+void pic18_delay_cycles(unsigned long n);   /* Charges n instruction cycles to the model's clock */
+
+/* C18 intrinsics and the table instructions the firmware uses from _asm blocks */
+#define Nop()
+#define ClrWdt()
+#define Sleep()
+#define Reset()         pic18_reset()
+#define TblRdPostInc()  pic18_table_read(1)
+#define TblRdPostDec()  pic18_table_read(-1)
+#define TblWtPostInc()  pic18_table_write(1)
+#define TblWt()         pic18_table_write(0)
+
+#pragma pack(1)
+
+#endif /* PIC18_HOST_P18CXXX_H */
@@ -0,0 +1,239 @@
+#include "pic18_model.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <p18cxxx.h>
+
+volatile PIC18_SFRS pic18_sfr;
+
+static uint8_t flash[PIC18_FLASH_SIZE];
+static uint8_t user_id[PIC18_USER_ID_SIZE];
+static uint8_t config[PIC18_CONFIG_SIZE];
+static uint8_t eeprom[PIC18_EEPROM_SIZE];
+static uint8_t holding[PIC18_WRITE_BLOCK_SIZE];
+static pic18_counters counters;
+static uint64_t cycles;
+static pic18_reset_handler reset_handler;
+static pic18_ppbrst_handler ppbrst_handler;
+
+/* Unprogrammed config words and the DEVID1/DEVID2 of a PIC18F2550 (rev 7), from the datasheet */
+static const uint8_t config_erased[PIC18_CONFIG_SIZE] = {
+    0x00, 0x05, 0x1F, 0x1F, 0x00, 0x83, 0x85, 0x00, 0x0F, 0xC0, 0x0F, 0xE0, 0x0F, 0x40,
+};
+static const uint8_t device_id[2] = {0x47, 0x12};
+
+/* Storage behind a table pointer address, NULL where nothing is implemented */
+static uint8_t* locate(uint32_t address)
+{
+    if(address < PIC18_FLASH_SIZE)
+        return &flash[address];
+    if(address - PIC18_USER_ID_ADDRESS < PIC18_USER_ID_SIZE)
+        return &user_id[address - PIC18_USER_ID_ADDRESS];
+    if(address - PIC18_CONFIG_ADDRESS < PIC18_CONFIG_SIZE)
+        return &config[address - PIC18_CONFIG_ADDRESS];
+    return NULL;
+}
+
+static uint8_t read_table(uint32_t address)
+{
+    const uint8_t* p;
+
+    if(address - PIC18_DEVICE_ID_ADDRESS < sizeof device_id)
+        return device_id[address - PIC18_DEVICE_ID_ADDRESS];
+    p = locate(address);
+    return p != NULL ? *p : 0x00;        /* Unimplemented memory reads as 0 */
+}
+
+void pic18_model_reset_registers(void)
+{
+    memset((void*)&pic18_sfr, 0, sizeof pic18_sfr);
+    pic18_sfr.trisa.v = 0x7F;
+    pic18_sfr.trisb.v = 0xFF;
+    pic18_sfr.trisc.v = 0xC7;
+    pic18_sfr.portb.bits.RB0 = 1;        /* sw2 released */
+    memset(holding, 0xFF, sizeof holding);
+}
+
+void pic18_model_power_on(void)
+{
+    memset(flash, 0xFF, sizeof flash);
+    memset(user_id, 0xFF, sizeof user_id);
+    memcpy(config, config_erased, sizeof config);
+    memset(eeprom, 0xFF, sizeof eeprom);
+    memset(&counters, 0, sizeof counters);
+    cycles = 0;
+    pic18_model_reset_registers();
+}
+
+uint8_t pic18_peek(uint32_t address)
+{
+    if(address - PIC18_EEPROM_ADDRESS < PIC18_EEPROM_SIZE)
+        return eeprom[address - PIC18_EEPROM_ADDRESS];
+    return read_table(address);
+}
+
+void pic18_poke(uint32_t address, uint8_t value)
+{
+    uint8_t* p;
+
+    if(address - PIC18_EEPROM_ADDRESS < PIC18_EEPROM_SIZE)
+    {
+        eeprom[address - PIC18_EEPROM_ADDRESS] = value;
+        return;
+    }
+    p = locate(address);
+    if(p != NULL)
+        *p = value;
+}
+
+const pic18_counters* pic18_model_counters(void)
+{
+    return &counters;
+}
+
+uint64_t pic18_cycles(void)
+{
+    return cycles;
+}
+
+void pic18_set_reset_handler(pic18_reset_handler handler)
+{
+    reset_handler = handler;
+}
+
+void pic18_set_ppbrst_handler(pic18_ppbrst_handler handler)
+{
+    ppbrst_handler = handler;
+}
+
+/* Firmware side, see p18cxxx.h */
+
+void pic18_delay_cycles(unsigned long n)
+{
+    cycles += n;
+}
+
+static void write_wait(unsigned long n)
+{
+    cycles += n;
+    counters.write_cycles += n;
+}
+
+/* The model only finds out about RD when EEADR or EEDATA is next touched, so the read is done then */
+static void complete_eeprom_read(void)
+{
+    if(pic18_sfr.eecon1.bits.RD)
+    {
+        pic18_sfr.eedata = eeprom[pic18_sfr.eeadr];
+        pic18_sfr.eecon1.bits.RD = 0;
+    }
+}
+
+volatile unsigned char* pic18_eeadr(void)
+{
+    complete_eeprom_read();
+    return &pic18_sfr.eeadr;
+}
+
+volatile unsigned char* pic18_eedata(void)
+{
+    complete_eeprom_read();
+    return &pic18_sfr.eedata;
+}
+
+/* Likewise PPBRST, which the firmware clears again right after setting it */
+volatile PIC18_UCONbits* pic18_uconbits(void)
+{
+    if(pic18_sfr.ucon.bits.PPBRST && ppbrst_handler != NULL)
+        ppbrst_handler();
+    return &pic18_sfr.ucon.bits;
+}
+
+void pic18_table_read(int step)
+{
+    pic18_sfr.tablat = read_table(pic18_sfr.tblptr.ptr);
+    pic18_sfr.tblptr.ptr += step;
+}
+
+void pic18_table_write(int step)
+{
+    holding[pic18_sfr.tblptr.ptr % PIC18_WRITE_BLOCK_SIZE] = pic18_sfr.tablat;
+    pic18_sfr.tblptr.ptr += step;
+}
+
+static void erase_row(uint32_t address)
+{
+    uint32_t i;
+    uint8_t* p;
+
+    address &= ~(uint32_t)(PIC18_ERASE_ROW_SIZE - 1);
+    for(i = 0; i < PIC18_ERASE_ROW_SIZE; i++)
+    {
+        p = locate(address + i);
+        if(p != NULL && address + i < PIC18_CONFIG_ADDRESS)
+            *p = 0xFF;
+    }
+    counters.row_erases++;
+}
+
+static void write_block(uint32_t address)
+{
+    uint32_t i;
+    uint8_t* p;
+
+    address &= ~(uint32_t)(PIC18_WRITE_BLOCK_SIZE - 1);
+    for(i = 0; i < PIC18_WRITE_BLOCK_SIZE; i++)
+    {
+        p = locate(address + i);
+        if(p != NULL && address + i < PIC18_CONFIG_ADDRESS)
+            *p &= holding[i];            /* Programming can only turn 1s into 0s */
+        holding[i] = 0xFF;
+    }
+    counters.block_writes++;
+}
+
+void pic18_activate_write(void)
+{
+    uint32_t address = pic18_sfr.tblptr.ptr;
+    uint8_t* p;
+
+    if(!pic18_sfr.eecon1.bits.WREN || pic18_sfr.eecon2 != 0xAA)
+    {
+        pic18_sfr.eecon1.bits.WRERR = 1;
+        counters.write_errors++;
+    }
+    else if(!pic18_sfr.eecon1.bits.EEPGD && !pic18_sfr.eecon1.bits.CFGS)
+    {
+        eeprom[pic18_sfr.eeadr] = pic18_sfr.eedata;
+        counters.eeprom_writes++;
+        write_wait(PIC18_EEPROM_WRITE_CYCLES);
+    }
+    else if(pic18_sfr.eecon1.bits.CFGS && address - PIC18_CONFIG_ADDRESS < PIC18_CONFIG_SIZE)
+    {
+        p = locate(address);
+        *p = holding[address % PIC18_WRITE_BLOCK_SIZE];
+        holding[address % PIC18_WRITE_BLOCK_SIZE] = 0xFF;
+        counters.config_writes++;
+        write_wait(PIC18_CONFIG_WRITE_CYCLES);
+    }
+    else if(pic18_sfr.eecon1.bits.FREE)
+    {
+        erase_row(address);
+        write_wait(PIC18_ROW_ERASE_CYCLES);
+    }
+    else
+    {
+        write_block(address);
+        write_wait(PIC18_BLOCK_WRITE_CYCLES);
+    }
+    pic18_sfr.eecon2 = 0;
+    pic18_sfr.eecon1.bits.WR = 0;
+}
+
+void pic18_reset(void)
+{
+    if(reset_handler != NULL)
+        reset_handler();
+    abort();                            /* The handler must not return, there is nothing to go back to */
+}
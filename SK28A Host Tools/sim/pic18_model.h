@@ -0,0 +1,84 @@
+/*
+ * Software model of the PIC18F2550 memories behind the host build of the
+ * bootloader: program flash, User ID, config words and data EEPROM, with the
+ * table read/write and self-write rules of the real part.
+ *
+ * - TBLWT only loads the 32 byte holding registers.  A write (EECON1 with
+ *   EEPGD set, FREE clear) programs the whole 32 byte block TBLPTR is in,
+ *   and programming can only clear bits.
+ * - An erase (FREE set) sets the whole 64 byte row to 0xFF.
+ * - Config words are written a byte at a time (CFGS set).
+ * - Nothing happens unless WREN is set and EECON2 was last written 0xAA;
+ *   WRERR is set instead.
+ *
+ * Time is kept on a virtual clock in instruction cycles (12 MIPS from the
+ * 48 MHz PLL clock).  Self-writes charge their typical duration from the
+ * datasheet, since the CPU stalls (flash) or polls WR (EEPROM) until they're
+ * done.  Everything else is charged by whoever runs the firmware, see
+ * pic18_delay_cycles().
+ *
+ * There is one device per process: the firmware keeps its state in globals.
+ */
+#ifndef PIC18_MODEL_H
+#define PIC18_MODEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIC18_FLASH_SIZE        0x8000u
+#define PIC18_USER_ID_ADDRESS   0x200000u
+#define PIC18_USER_ID_SIZE      8u
+#define PIC18_CONFIG_ADDRESS    0x300000u
+#define PIC18_CONFIG_SIZE       14u
+#define PIC18_DEVICE_ID_ADDRESS 0x3FFFFEu
+#define PIC18_EEPROM_ADDRESS    0xF00000u   /* Where the bootloader protocol puts the EEPROM, see peek/poke */
+#define PIC18_EEPROM_SIZE       0x100u
+#define PIC18_WRITE_BLOCK_SIZE  32u
+#define PIC18_ERASE_ROW_SIZE    64u
+
+#define PIC18_CYCLES_PER_MS         12000u
+#define PIC18_ROW_ERASE_CYCLES      (2u * PIC18_CYCLES_PER_MS)
+#define PIC18_BLOCK_WRITE_CYCLES    (2u * PIC18_CYCLES_PER_MS)
+#define PIC18_CONFIG_WRITE_CYCLES   (2u * PIC18_CYCLES_PER_MS)
+#define PIC18_EEPROM_WRITE_CYCLES   (4u * PIC18_CYCLES_PER_MS)
+
+/* Self-programming operations carried out since the last pic18_model_power_on() */
+typedef struct {
+    unsigned long row_erases;
+    unsigned long block_writes;
+    unsigned long config_writes;
+    unsigned long eeprom_writes;
+    unsigned long write_errors;         /* Activations without WREN or the unlock sequence */
+    uint64_t write_cycles;              /* Time spent waiting for all of the above */
+} pic18_counters;
+
+/* Memories erased (config words at their unprogrammed values), registers at their reset values */
+void pic18_model_power_on(void);
+/* Registers only, the memories keep their contents */
+void pic18_model_reset_registers(void);
+
+/* Direct access for setting up and checking a scenario.  The EEPROM is at PIC18_EEPROM_ADDRESS. */
+uint8_t pic18_peek(uint32_t address);
+void pic18_poke(uint32_t address, uint8_t value);
+
+const pic18_counters* pic18_model_counters(void);
+
+/* Instruction cycles since pic18_model_power_on().  pic18_delay_cycles() (see p18cxxx.h) advances it. */
+uint64_t pic18_cycles(void);
+
+/* Where pic18_reset() (the Reset instruction) jumps to.  Set by firmware_sim.c. */
+typedef void (*pic18_reset_handler)(void);
+void pic18_set_reset_handler(pic18_reset_handler handler);
+
+/* What UCONbits.PPBRST = 1 does to the SIE: its ping-pong pointers go back to the even BDs.  Set by firmware_sim.c. */
+typedef void (*pic18_ppbrst_handler)(void);
+void pic18_set_ppbrst_handler(pic18_ppbrst_handler handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIC18_MODEL_H */
@@ -0,0 +1,75 @@
+#include "sk28a/board_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include "sk28a/journal.h"
+
+namespace sk28a {
+
+namespace {
+
+void flash_one(const BoardTarget& board, size_t index, const ImageView& image, const FlashOptions& options,
+               const BoardProgressCallback& progress, BoardResult& result) {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Transport> transport;
+    try {
+        transport = board.open();
+        Flasher flasher(*transport, options);
+        if (progress) {
+            flasher.set_progress([&](std::string_view phase, uint64_t done, uint64_t total) {
+                progress(index, phase, done, total);
+            });
+        }
+        const ImageView to_flash =
+            board.user_id ? image.with(kUserIdAddress, board.user_id->data(), board.user_id->size()) : image;
+        if (!board.journal.empty()) {
+            Journal journal(board.journal);
+            result.resumed = flasher.flash(to_flash, journal);
+        } else {
+            flasher.flash(to_flash);
+        }
+        result.bytes = flasher.writable_part(to_flash).byte_count();
+        result.ok = true;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    if (transport)
+        result.stats = transport->stats();
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+}  // namespace
+
+std::vector<BoardResult> flash_boards(const std::vector<BoardTarget>& boards, const ImageView& image,
+                                      const FlashOptions& options, unsigned jobs,
+                                      const BoardProgressCallback& progress, const BoardDoneCallback& done) {
+    std::vector<BoardResult> results(boards.size());
+    for (size_t i = 0; i < boards.size(); ++i) {
+        results[i].name = boards[i].name;
+        results[i].location = boards[i].location;
+    }
+
+    // Workers take the next board off the list until it is empty.  A Flasher only ever blocks on its own
+    // board's transport, so one thread per board in flight keeps a stalled board from holding up the rest.
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i; (i = next++) < boards.size();) {
+            flash_one(boards[i], i, image, options, progress, results[i]);
+            if (done)
+                done(i, results[i]);
+        }
+    };
+    const size_t workers = jobs == 0 ? boards.size() : std::min<size_t>(jobs, boards.size());
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (size_t i = 0; i < workers; ++i)
+        threads.emplace_back(worker);
+    for (std::thread& t : threads)
+        t.join();
+    return results;
+}
+
+}  // namespace sk28a
@@ -0,0 +1,129 @@
+#include "sk28a/firmware_device.h"
+
+#include "firmware_sim.h"
+#include "pic18_model.h"
+
+namespace sk28a {
+
+namespace {
+
+// The firmware keeps its state in globals, so there is only one part to go round
+bool in_use = false;
+
+// A write that is still NAKed after this long means the firmware has stopped servicing its endpoint
+constexpr std::chrono::milliseconds kWriteTimeout{5000};
+
+uint64_t to_cycles(std::chrono::milliseconds t) {
+    return t.count() > 0 ? static_cast<uint64_t>(t.count()) * PIC18_CYCLES_PER_MS : 0;
+}
+
+std::chrono::microseconds to_time(uint64_t cycles) {
+    return std::chrono::microseconds(cycles * 1000 / PIC18_CYCLES_PER_MS);
+}
+
+}  // namespace
+
+FirmwareDevice::FirmwareDevice() {
+    if (in_use)
+        throw TransportError("only one host build of the firmware can run at a time");
+    if (fwsim_power_on() != 0)
+        throw TransportError("host build of the firmware did not enumerate");
+    in_use = true;
+}
+
+FirmwareDevice::~FirmwareDevice() { in_use = false; }
+
+// One pass of the main loop, with the host side of the bus: a device that
+// reset itself is enumerated again, and IN reports are collected as soon as
+// they are ready so the firmware never stalls on a full endpoint.
+void FirmwareDevice::step() {
+    fwsim_step();
+    if (!fwsim_configured() && fwsim_enumerate() != 0)
+        throw TransportError("host build of the firmware did not enumerate after a reset");
+    Packet packet;
+    while (fwsim_in(packet.bytes.data()) >= 0)
+        responses_.push_back(packet);
+}
+
+void FirmwareDevice::write(const Packet& packet) {
+    const uint64_t deadline = fwsim_cycles() + to_cycles(kWriteTimeout);
+    uint64_t first_nak = 0;
+    bool naked = false;
+    while (fwsim_cycles() < deadline) {
+        const uint64_t now = fwsim_cycles();
+        const int taken = fwsim_out(packet.bytes.data(), kPacketSize);
+        if (taken == 0) {
+            ++nak_count_;
+            if (!naked)
+                first_nak = now;
+            naked = true;
+        }
+        if (taken > 0 && naked)
+            nak_cycles_ += now - first_nak;
+        step();
+        if (taken > 0) {
+            ++stats_.reports_written;
+            return;
+        }
+    }
+    throw TransportError("firmware kept NAKing its OUT endpoint");
+}
+
+bool FirmwareDevice::read(Packet& packet, std::chrono::milliseconds timeout) {
+    const uint64_t deadline = fwsim_cycles() + to_cycles(timeout);
+    while (responses_.empty()) {
+        step();
+        if (fwsim_cycles() >= deadline)
+            break;
+    }
+    if (responses_.empty())
+        return false;
+    packet = responses_.front();
+    responses_.pop_front();
+    ++stats_.reports_read;
+    return true;
+}
+
+std::vector<uint8_t> FirmwareDevice::descriptor(uint8_t type, uint8_t index, uint16_t language) {
+    constexpr uint8_t kGetDescriptor = 6;
+    constexpr uint8_t kReportDescriptor = 0x22;
+    constexpr uint16_t kLength = 255;
+    const uint8_t setup[8] = {
+        static_cast<uint8_t>(type == kReportDescriptor ? 0x81 : 0x80),
+        kGetDescriptor,
+        index,
+        type,
+        static_cast<uint8_t>(language),
+        static_cast<uint8_t>(language >> 8),
+        kLength,
+        0,
+    };
+    std::vector<uint8_t> data(kLength);
+    const int n = fwsim_control_in(setup, data.data(), kLength);
+    if (n < 0)
+        throw TransportError("firmware stalled GET_DESCRIPTOR " + std::to_string(type) + "/" + std::to_string(index));
+    data.resize(static_cast<size_t>(n));
+    return data;
+}
+
+void FirmwareDevice::clear_halt(uint8_t endpoint) {
+    constexpr uint8_t kClearFeature = 1;
+    constexpr uint8_t kEndpointHalt = 0;
+    const uint8_t setup[8] = {0x02, kClearFeature, kEndpointHalt, 0, endpoint, 0, 0, 0};
+    if (fwsim_control_in(setup, nullptr, 0) != 0)
+        throw TransportError("firmware stalled CLEAR_FEATURE(ENDPOINT_HALT) " + std::to_string(endpoint));
+}
+
+uint8_t FirmwareDevice::peek(uint32_t address) const { return pic18_peek(address); }
+
+void FirmwareDevice::poke(uint32_t address, uint8_t value) { pic18_poke(address, value); }
+
+unsigned long FirmwareDevice::reset_count() const { return fwsim_reset_count(); }
+
+std::chrono::microseconds FirmwareDevice::virtual_time() const { return to_time(fwsim_cycles()); }
+
+std::chrono::microseconds FirmwareDevice::nak_time() const { return to_time(nak_cycles_); }
+
+std::chrono::microseconds FirmwareDevice::write_time() const { return to_time(pic18_model_counters()->write_cycles); }
+
+}  // namespace sk28a
@@ -0,0 +1,619 @@
+#include "sk28a/flasher.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <thread>
+
+#include "sk28a/journal.h"
+
+namespace sk28a {
+
+namespace {
+
+std::string hex_address(uint32_t address) {
+    char buf[16];
+    std::snprintf(buf, sizeof buf, "0x%06X", address);
+    return buf;
+}
+
+constexpr uint32_t kRowMask = static_cast<uint32_t>(kEraseRowSize) - 1;
+constexpr uint32_t kBlockSize = static_cast<uint32_t>(kProgramBlockSize);
+constexpr uint32_t kJournalChunk = 1024;  // Bytes programmed and verified between journal entries
+constexpr uint32_t kEndOfMemory = 0xFFFFFFFF;
+
+uint32_t row_start(uint32_t address) { return address & ~kRowMask; }
+uint32_t row_end(uint32_t address) { return (address + kRowMask) & ~kRowMask; }
+uint32_t block_start(uint32_t address) { return address & ~(kBlockSize - 1); }
+
+// The image without its config words, which are small and always sent again
+ImageView without_config(const ImageView& image) {
+    return image.slices({{0, 0x300000}, {0x310000, kEndOfMemory}});
+}
+
+}  // namespace
+
+VerifyError::VerifyError(uint32_t address_, uint8_t expected_, uint8_t actual_)
+    : std::runtime_error([&] {
+          char buf[80];
+          std::snprintf(buf, sizeof buf, "verify failed at 0x%06X: expected 0x%02X, read 0x%02X", address_, expected_,
+                        actual_);
+          return std::string(buf);
+      }()),
+      address(address_),
+      expected(expected_),
+      actual(actual_) {}
+
+Flasher::Flasher(Transport& transport, FlashOptions options) : transport_(transport), options_(options) {
+    if (options_.window == 0)
+        options_.window = 1;
+}
+
+void Flasher::report(std::string_view phase, uint64_t done, uint64_t total) {
+    if (progress_)
+        progress_(phase, done, total);
+}
+
+Packet Flasher::await(Command expected, std::chrono::milliseconds timeout) {
+    Packet p;
+    if (!transport_.read(p, timeout))
+        throw ProtocolError("no " + to_string(expected) + " response from " + transport_.description() + " within " +
+                            std::to_string(timeout.count()) + " ms");
+    if (p.command() != expected)
+        throw ProtocolError("expected a " + to_string(expected) + " response, got " + to_string(p.command()));
+    return p;
+}
+
+void Flasher::sync(std::chrono::milliseconds timeout) {
+    // The firmware handles one command at a time, in order, so once this is
+    // answered everything sent before it has been carried out.
+    transport_.write(make_command(Command::QueryDevice));
+    await(Command::QueryDevice, timeout);
+}
+
+const DeviceInfo& Flasher::query() {
+    Packet stale;
+    while (transport_.read(stale, std::chrono::milliseconds(0))) {
+    }
+    transport_.write(make_command(Command::QueryDevice));
+    info_ = parse_query_response(await(Command::QueryDevice, options_.timeout));
+    if (info_.bytes_per_address != 1)
+        throw ProtocolError("not a PIC18 bootloader (BytesPerAddress " + std::to_string(info_.bytes_per_address) + ")");
+    return info_;
+}
+
+ImageView Flasher::writable_part(const ImageView& image) const {
+    std::vector<std::pair<uint32_t, uint32_t>> regions;
+    for (const MemoryRegion& r : info_.regions) {
+        if (r.type != MemoryType::Config || options_.program_config)
+            regions.emplace_back(r.address, r.end());
+    }
+    return image.slices(std::move(regions));
+}
+
+void Flasher::wait_for_background_erase() {
+    const auto deadline = std::chrono::steady_clock::now() + options_.erase_timeout;
+    for (;;) {
+        transport_.write(make_command(Command::GetEraseStatus));
+        EraseStatus s = parse_status_response(await(Command::GetEraseStatus, options_.timeout));
+        report("erase", s.pages_done, s.pages_done + s.pages_remaining);
+        if (!s.busy)
+            return;
+        if (std::chrono::steady_clock::now() > deadline)
+            throw ProtocolError("erase did not finish within " + std::to_string(options_.erase_timeout.count()) + " ms");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+void Flasher::erase(const ImageView& image) {
+    switch (options_.erase) {
+    case EraseMode::None:
+        return;
+    case EraseMode::Lazy:
+        if (!info_.has(feature::kLazyErase))
+            throw ProtocolError("this bootloader build can't erase on first write (USE_LAZY_ERASE)");
+        return;
+    case EraseMode::Patch: {
+        if (!info_.has(feature::kPatch))
+            throw ProtocolError("this bootloader build has no PATCH_DEVICE command (USE_PATCH_COMMAND)");
+        // Flash only takes new data once erased, and PATCH_DEVICE stays inside the application's program memory
+        const ImageView part = writable_part(image);
+        for (const ImageView::Run& run : part.runs()) {
+            if (is_user_id_address(run.address))
+                throw ProtocolError("PATCH_DEVICE can't write the User ID; erase it with ERASE_RANGE (--erase range)");
+        }
+        return;
+    }
+    case EraseMode::Full:
+        report("erase", 0, 1);
+        transport_.write(make_command(Command::EraseDevice));
+        break;
+    case EraseMode::Range: {
+        if (!info_.has(feature::kEraseRange))
+            throw ProtocolError("this bootloader build has no ERASE_RANGE command (USE_ERASE_RANGE_COMMAND)");
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        uint8_t flags = 0;
+        const ImageView part = writable_part(image);
+        for (const ImageView::Run& run : part.runs()) {
+            if (is_eeprom_address(run.address)) {
+                flags |= kEraseRangeEeprom;
+            } else if (is_user_id_address(run.address)) {
+                flags |= kEraseRangeUserId;
+            } else if (!is_config_address(run.address)) {
+                if (begin == end)
+                    begin = run.address;
+                end = run.end();
+            }
+        }
+        Packet p = make_range(Command::EraseRange, begin, end - begin);
+        p.set_u8(offset::kRangeFlags, flags);
+        report("erase", 0, 1);
+        transport_.write(p);
+        await(Command::EraseRange, info_.has(feature::kBackgroundErase) ? options_.timeout : options_.erase_timeout);
+        break;
+    }
+    }
+
+    if (info_.has(feature::kBackgroundErase))
+        wait_for_background_erase();
+    else if (options_.erase == EraseMode::Full)
+        sync(options_.erase_timeout);
+    report("erase", 1, 1);
+}
+
+void Flasher::send_section(const ImageView::Run& section, uint64_t& done, uint64_t total) {
+    const uint32_t address = section.address;
+    const uint8_t* bytes = section.data;
+    const size_t size = section.size;
+    // Program memory and User ID can go compressed, and runs of one value as FILL; EEPROM and the config words only
+    // take PROGRAM_DEVICE
+    const bool program_memory = !is_eeprom_address(address) && !is_config_address(address);
+    const bool compress = program_memory && info_.has(feature::kCompressedProgramming);
+    const bool fill = program_memory && info_.has(feature::kFill);
+    const size_t chunk = info_.packet_data_field_size;
+    if (program_memory && options_.erase == EraseMode::Patch) {
+        // The firmware reads, erases and rewrites every row a packet touches, so a packet never spans two
+        for (size_t at = 0; at < size;) {
+            const uint32_t a = address + static_cast<uint32_t>(at);
+            const size_t n = std::min<size_t>({chunk, size - at, row_end(a + 1) - a});
+            transport_.write(make_data_packet(Command::PatchDevice, a, bytes + at, n));
+            stats_.bytes += n;
+            stats_.payload += n;
+            ++stats_.packets;
+            at += n;
+            done += n;
+            report("program", done, total);
+        }
+        return;
+    }
+    // A FILL packet pays off once the run would take more room than it, plus the data packet it may cut short.
+    // Compressed, a run costs 2 bytes per 128.
+    const size_t min_fill = compress ? chunk / 2 * 128 : 2 * chunk;
+    auto run_length = [&](size_t at) {
+        size_t n = 1;
+        while (at + n < size && bytes[at + n] == bytes[at])
+            ++n;
+        return n;
+    };
+    // Start and length of the next run long enough for FILL, from `at` on
+    size_t fill_at = size;
+    size_t fill_size = 0;
+    auto find_fill = [&](size_t at) {
+        fill_at = size;
+        fill_size = 0;
+        while (fill && at < size) {
+            const size_t n = run_length(at);
+            if (n >= min_fill) {
+                fill_at = at;
+                fill_size = n;
+                return;
+            }
+            at += n;
+        }
+    };
+    find_fill(0);
+
+    std::vector<uint8_t> encoded;
+    for (size_t at = 0; at < size;) {
+        if (at == fill_at) {
+            Packet p = make_range(Command::Fill, address + static_cast<uint32_t>(at), static_cast<uint32_t>(fill_size));
+            p.set_u8(offset::kFillValue, bytes[at]);
+            transport_.write(p);
+            stats_.bytes += fill_size;
+            stats_.payload += 1;
+            ++stats_.packets;
+            ++stats_.fill_packets;
+            at += fill_size;
+            done += fill_size;
+            report("program", done, total);
+            find_fill(at);
+            continue;
+        }
+        const size_t limit = fill_at - at;  // The data packets stop short of the next FILL
+        size_t n = std::min(chunk, limit);
+        Command command = Command::ProgramDevice;
+        const uint8_t* payload = bytes + at;
+        size_t payload_size = n;
+        if (compress) {
+            const size_t taken = packbits_encode(bytes + at, limit, chunk, encoded);
+            if (encoded.size() < taken) {
+                command = Command::ProgramCompressed;
+                n = taken;
+                payload = encoded.data();
+                payload_size = encoded.size();
+                ++stats_.compressed_packets;
+            }
+        }
+        transport_.write(make_data_packet(command, address + static_cast<uint32_t>(at), payload, payload_size));
+        stats_.bytes += n;
+        stats_.payload += payload_size;
+        ++stats_.packets;
+        at += n;
+        done += n;
+        report("program", done, total);
+    }
+}
+
+ImageView Flasher::program_part(const ImageView& image) const {
+    ImageView part = writable_part(image);
+    if (options_.erase == EraseMode::Full || options_.erase == EraseMode::Range) {
+        // Freshly erased flash already holds the image's blank blocks (not so for lazy erase: rows that get no
+        // writes are never erased).  Splitting a section costs nothing when the firmware takes address jumps.
+        const unsigned min_run = info_.has(feature::kAutoSectionProgramming) ? 1 : 4;
+        for (const MemoryRegion& r : info_.regions) {
+            if (r.type == MemoryType::Program && !is_user_id_address(r.address))
+                part = part.without_blank_blocks(kProgramBlockSize, r.address, r.end(), min_run);
+        }
+    }
+    return part;
+}
+
+void Flasher::send_sections(const ImageView& part, uint64_t& done, uint64_t total) {
+    // Program memory and User ID: contiguous sections, each closed with PROGRAM_COMPLETE so the firmware flushes its
+    // partial block and accepts a new start address.  A firmware that takes address jumps by itself
+    // (ExtAutoSectionProgramming) gets them back to back, closed by a single PROGRAM_COMPLETE.
+    // PATCH_DEVICE packets stand alone.  (A PROGRAM_COMPLETE after them would be worse than useless on a
+    // LAZY_ERASE_UNTOUCHED_ROWS build, which then erases every row not written since the reset.)
+    const bool auto_section = info_.has(feature::kAutoSectionProgramming);
+    bool open = false;
+    for (const ImageView::Run& run : part.runs()) {
+        if (is_config_address(run.address))
+            continue;
+        if (options_.erase == EraseMode::Patch) {
+            send_section(run, done, total);
+            continue;
+        }
+        if (is_eeprom_address(run.address)) {
+            if (open) {
+                transport_.write(make_command(Command::ProgramComplete));
+                open = false;
+            }
+            // EEPROM is written a byte at a time as packets arrive, no sections involved
+            send_section(run, done, total);
+            continue;
+        }
+        send_section(run, done, total);
+        if (auto_section)
+            open = true;
+        else
+            transport_.write(make_command(Command::ProgramComplete));
+    }
+    if (open)
+        transport_.write(make_command(Command::ProgramComplete));
+}
+
+void Flasher::program_config_words(const ImageView& part, uint64_t& done, uint64_t total) {
+    // Config words last, so a bad write can't leave the device without its application
+    bool unlocked = false;
+    for (const ImageView::Run& run : part.runs()) {
+        if (!is_config_address(run.address))
+            continue;
+        if (!unlocked) {
+            transport_.write(make_unlock_config(true));
+            unlocked = true;
+        }
+        send_section(run, done, total);
+    }
+    if (unlocked)
+        transport_.write(make_unlock_config(false));
+}
+
+void Flasher::program(const ImageView& image) {
+    const ImageView part = program_part(image);
+    const uint64_t total = part.byte_count();
+    uint64_t done = 0;
+    stats_ = {};
+    report("program", 0, total);
+
+    send_sections(part, done, total);
+    program_config_words(part, done, total);
+
+    sync(options_.timeout);
+}
+
+std::vector<uint8_t> Flasher::read(uint32_t address, uint32_t length) {
+    std::vector<uint8_t> out(length);
+    if (length == 0)
+        return out;
+
+    if (info_.has(feature::kReadStream)) {
+        // One request, the device streams the responses back to back
+        transport_.write(make_range(Command::ReadStream, address, length));
+        for (uint32_t received = 0; received < length;) {
+            Packet p = await(Command::ReadStream, options_.timeout);
+            if (p.address() != address + received || p.size() == 0 || p.size() > length - received)
+                throw ProtocolError("READ_STREAM response out of sequence at " + hex_address(p.address()));
+            std::copy(p.payload(), p.payload() + p.size(), out.begin() + received);
+            received += p.size();
+        }
+        return out;
+    }
+
+    // Keep up to `window` GET_DATA requests outstanding instead of waiting for each answer
+    const uint32_t chunk = info_.packet_data_field_size;
+    std::deque<std::pair<uint32_t, uint8_t>> outstanding;
+    uint32_t requested = 0;
+    uint32_t received = 0;
+    while (received < length) {
+        while (outstanding.size() < options_.window && requested < length) {
+            const auto n = static_cast<uint8_t>(std::min(chunk, length - requested));
+            transport_.write(make_get_data(address + requested, n));
+            outstanding.emplace_back(address + requested, n);
+            requested += n;
+        }
+        Packet p = await(Command::GetData, options_.timeout);
+        const auto [want_address, want_size] = outstanding.front();
+        if (p.address() != want_address || p.size() != want_size)
+            throw ProtocolError("GET_DATA response out of sequence at " + hex_address(p.address()));
+        std::copy(p.payload(), p.payload() + p.size(), out.begin() + received);
+        received += p.size();
+        outstanding.pop_front();
+    }
+    return out;
+}
+
+void Flasher::verify_bytes(const ImageView::Run& expected) {
+    const std::vector<uint8_t> actual = read(expected.address, static_cast<uint32_t>(expected.size));
+    auto mismatch = std::mismatch(expected.data, expected.data + expected.size, actual.begin());
+    if (mismatch.first != expected.data + expected.size) {
+        const auto at = static_cast<uint32_t>(mismatch.first - expected.data);
+        throw VerifyError(expected.address + at, *mismatch.first, *mismatch.second);
+    }
+}
+
+void Flasher::check_verify_mode() const {
+    if (options_.verify == VerifyMode::Crc && !info_.has(feature::kVerifyRange))
+        throw ProtocolError("this bootloader build has no VERIFY_RANGE command (USE_VERIFY_RANGE_COMMAND)");
+}
+
+uint16_t Flasher::device_crc(uint32_t address, uint32_t length) {
+    transport_.write(make_range(Command::VerifyRange, address, length));
+    return await(Command::VerifyRange, options_.timeout).u16(offset::kChecksum);
+}
+
+bool Flasher::rows_check_out(const ImageView& image, const ImageView::Run& run) {
+    // A stored row CRC covers the whole row, with 0xFF where the image has nothing.  That is what the board holds
+    // once the image is in, if the row was erased first and the image has nothing in it outside this run.
+    if (options_.erase != EraseMode::Full && options_.erase != EraseMode::Range && options_.erase != EraseMode::Lazy)
+        return false;
+    if (region_kind(run.address) != RegionKind::Program)
+        return false;
+    const uint32_t begin = row_start(run.address);
+    const uint32_t end = row_end(run.end());
+    uint16_t expected = 0;
+    for (uint32_t row = begin; row < end; row += kRowMask + 1) {
+        uint16_t crc;
+        uint64_t present;
+        if (!image.stored_row(row, crc, present))
+            return false;
+        const uint32_t b = std::max(run.address, row) - row;
+        const uint32_t e = std::min(run.end(), row + kRowMask + 1) - row;
+        const uint64_t in_run = (e == 64 ? ~uint64_t{0} : (uint64_t{1} << e) - 1) & ~((uint64_t{1} << b) - 1);
+        if ((present & ~in_run) != 0)
+            return false;
+        expected = row == begin ? crc : crc16_ccitt_combine(expected, crc, kEraseRowSize);
+    }
+    return device_crc(begin, end - begin) == expected;
+}
+
+void Flasher::verify_section(const ImageView& image, const ImageView::Run& run) {
+    if (options_.verify == VerifyMode::Crc) {
+        if (rows_check_out(image, run))
+            return;
+        if (device_crc(run.address, static_cast<uint32_t>(run.size)) != crc16_ccitt(run.data, run.size)) {
+            verify_bytes(run);  // Pinpoints the first bad byte
+            throw ProtocolError("VERIFY_RANGE checksum mismatch at " + hex_address(run.address) +
+                                ", although the data reads back correctly");
+        }
+    } else if (options_.verify == VerifyMode::Read) {
+        verify_bytes(run);
+    }
+}
+
+void Flasher::verify(const ImageView& image) {
+    if (options_.verify == VerifyMode::None)
+        return;
+    check_verify_mode();
+
+    // The config words aren't verified: several bits read back differently from what the hex file says
+    const ImageView part = without_config(writable_part(image));
+    const uint64_t total = part.byte_count();
+    uint64_t done = 0;
+    report("verify", 0, total);
+
+    for (const ImageView::Run& run : part.runs()) {
+        verify_section(part, run);
+        done += run.size;
+        report("verify", done, total);
+    }
+}
+
+void Flasher::reset() {
+    transport_.write(make_command(Command::ResetDevice));
+}
+
+void Flasher::flash(const ImageView& image) {
+    query();
+    if (writable_part(image).empty())
+        throw ProtocolError("the image has nothing in the memory ranges this device reports");
+    erase(image);
+    program(image);
+    verify(image);
+    if (options_.reset)
+        reset();
+}
+
+uint32_t Flasher::first_mismatch(const ImageView& image, const ImageView::Run& expected) {
+    const uint32_t address = expected.address;
+    const auto size = static_cast<uint32_t>(expected.size);
+    if (!info_.has(feature::kVerifyRange)) {
+        const std::vector<uint8_t> actual = read(address, size);
+        return address + static_cast<uint32_t>(std::mismatch(expected.data, expected.data + size, actual.begin()).first -
+                                                expected.data);
+    }
+    if (rows_check_out(image, expected))
+        return address + size;
+    auto matches_up_to = [&](uint32_t end) {
+        return device_crc(address, end - address) == crc16_ccitt(expected.data, end - address);
+    };
+    // Bisect on block boundaries: the bytes up to `good` match, those up to `bad` don't
+    uint32_t good = address;
+    uint32_t bad = address + size;
+    if (matches_up_to(bad))
+        return bad;
+    for (;;) {
+        uint32_t mid = block_start(good + (bad - good) / 2);
+        if (mid <= good)
+            mid = block_start(good + kBlockSize);
+        if (mid >= bad)
+            return good;
+        (matches_up_to(mid) ? good : bad) = mid;
+    }
+}
+
+uint32_t Flasher::check_journaled(const ImageView& body, uint32_t done) {
+    // What the journal has programmed has to be on the board still (it may have been reset halfway through a
+    // write, or be another board altogether).  The chunk that was on its way when the run stopped may have
+    // made it too, up to some block.  The rows the journal has are complete, so they go apart from that chunk,
+    // where the CRCs an .sk28img stores for its rows can't be checked against.
+    const ImageView journaled = body.slice(0, done);
+    const ImageView in_flight = body.slice(done, done + kJournalChunk);
+    uint32_t from = done + kJournalChunk;
+    const uint64_t total = journaled.byte_count() + in_flight.byte_count();
+    uint64_t checked = 0;
+    report("check", 0, total);
+    auto check = [&](const ImageView& part) {
+        for (const ImageView::Run& run : part.runs()) {
+            const uint32_t bad = first_mismatch(part, run);
+            if (bad != run.end()) {
+                from = block_start(bad);
+                return false;
+            }
+            checked += run.size;
+            report("check", checked, total);
+        }
+        return true;
+    };
+    if (check(journaled))
+        check(in_flight);
+
+    // Patched rows keep whatever else they hold, so patching picks up at any block.  A lazy erase build erases a
+    // row on the first write to it since it started, whatever the host asked for, so there the row is written
+    // again from its start.  Otherwise writes pick up at a block, which has to be erased.  EEPROM takes writes
+    // over whatever it holds.
+    if (options_.erase == EraseMode::Patch)
+        return from;
+    if (info_.has(feature::kLazyErase))
+        return row_start(from);
+    if (options_.erase == EraseMode::None)
+        return from;
+    // The journal only gets entries once the erase is through, and nothing past the chunk in flight had been
+    // written since, unless what the journal has didn't check out
+    const ImageView rest = body.slice(from, from >= done ? done + kJournalChunk : kEndOfMemory);
+    for (const ImageView::Run& run : rest.runs()) {
+        if (is_eeprom_address(run.address))
+            continue;
+        const std::vector<uint8_t> blank(run.size, 0xFF);
+        if (first_mismatch(ImageView(), ImageView::Run{run.address, blank.data(), run.size}) != run.end()) {
+            if (options_.erase == EraseMode::Full)
+                return 0;  // Only ERASE_DEVICE can clear it
+            from = row_start(from);
+            erase(body.slice(from, kEndOfMemory));
+            break;
+        }
+    }
+    return from;
+}
+
+void Flasher::program_journaled(const ImageView& image, uint32_t from, bool erased, Journal& journal) {
+    // What has to end up on the board, and what gets sent for it: blank blocks are left out of erased flash
+    const ImageView body = without_config(writable_part(image).slice(from, kEndOfMemory));
+    const ImageView all = erased ? program_part(image) : writable_part(image);
+    const ImageView sent = without_config(all.slice(from, kEndOfMemory));
+    uint64_t total = sent.byte_count();
+    for (const ImageView::Run& run : all.runs()) {
+        if (is_config_address(run.address))
+            total += run.size;
+    }
+    uint64_t done = 0;
+    stats_ = {};
+    report("program", 0, total);
+
+    // In chunks, each one committed (PROGRAM_COMPLETE, then a round trip), verified and journaled before the
+    // next.  Chunks end on row boundaries, and so does what the journal is told, so a resumed run starts on a
+    // fresh row; a section that ends inside a row the next one starts in is journaled once that one is done.
+    uint32_t journaled = from;
+    const auto& runs = body.runs();
+    for (auto it = runs.begin(); it != runs.end(); ++it) {
+        const uint32_t address = it->address;
+        const auto size = static_cast<uint32_t>(it->size);
+        for (uint32_t at = 0; at < size;) {
+            const uint32_t begin = address + at;
+            const uint32_t n = std::min(size - at, row_start(begin + kJournalChunk) - begin);
+            send_sections(sent.slice(begin, begin + n), done, total);
+            sync(options_.timeout);
+            verify_section(body, ImageView::Run{begin, it->data + at, n});
+            at += n;
+
+            const uint32_t end = address + at;
+            const auto next = std::next(it);
+            const bool row_shared = at == size && next != runs.end() && next->address < row_end(end);
+            const uint32_t committed = row_shared ? row_start(end) : row_end(end);
+            if (committed > journaled) {
+                journal.commit(committed);
+                journaled = committed;
+            }
+        }
+    }
+    program_config_words(all, done, total);
+    sync(options_.timeout);
+}
+
+uint64_t Flasher::flash(const ImageView& image, Journal& journal) {
+    query();
+    const ImageView part = writable_part(image);
+    if (part.empty())
+        throw ProtocolError("the image has nothing in the memory ranges this device reports");
+    check_verify_mode();
+
+    const uint64_t image_fingerprint = fingerprint(part);
+    const ImageView body = without_config(part);
+    uint32_t from = journal.load(image_fingerprint);
+    if (from != 0)
+        from = check_journaled(body, from);
+    if (from == 0) {
+        journal.start(image_fingerprint);
+        erase(image);
+    } else {
+        journal.start(image_fingerprint, from);
+    }
+    // Resuming on a lazy erase build, rows get erased again as they are written to, so blank blocks have to go too
+    program_journaled(image, from, from == 0 || !info_.has(feature::kLazyErase), journal);
+    journal.remove();
+    if (options_.reset)
+        reset();
+    return body.slice(0, from).byte_count();
+}
+
+}  // namespace sk28a
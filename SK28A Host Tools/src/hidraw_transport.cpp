@@ -0,0 +1,109 @@
+#include "sk28a/hidraw_transport.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace sk28a {
+
+namespace {
+
+std::string errno_message(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+std::vector<HidrawDevice> find_hidraw_devices(uint16_t vendor_id, uint16_t product_id) {
+    std::vector<HidrawDevice> found;
+    DIR* dir = opendir("/sys/class/hidraw");
+    if (dir == nullptr)
+        return found;
+
+    char wanted[32];
+    std::snprintf(wanted, sizeof wanted, "%08X:%08X", vendor_id, product_id);
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "hidraw", 6) != 0)
+            continue;
+        // uevent of the HID device: HID_ID=<bus>:<vendor>:<product>, HID_PHYS=..., HID_UNIQ=...
+        std::ifstream uevent(std::string("/sys/class/hidraw/") + entry->d_name + "/device/uevent");
+        HidrawDevice dev;
+        bool match = false;
+        for (std::string line; std::getline(uevent, line);) {
+            if (line.rfind("HID_ID=", 0) == 0)
+                match = line.size() >= 7 + 5 + 17 && strcasecmp(line.c_str() + 7 + 5, wanted) == 0;
+            else if (line.rfind("HID_PHYS=", 0) == 0)
+                dev.phys = line.substr(9);
+            else if (line.rfind("HID_UNIQ=", 0) == 0)
+                dev.uniq = line.substr(9);
+        }
+        if (match) {
+            dev.path = std::string("/dev/") + entry->d_name;
+            found.push_back(dev);
+        }
+    }
+    closedir(dir);
+    std::sort(found.begin(), found.end(), [](const HidrawDevice& a, const HidrawDevice& b) {
+        return a.path.size() != b.path.size() ? a.path.size() < b.path.size() : a.path < b.path;
+    });
+    return found;
+}
+
+HidrawTransport::HidrawTransport(const std::string& path) : path_(path) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0)
+        throw TransportError(errno_message("cannot open " + path));
+}
+
+HidrawTransport::~HidrawTransport() {
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+void HidrawTransport::write(const Packet& packet) {
+    // hid_rpt01 has no report IDs, so hidraw wants a leading 0 that it strips again
+    uint8_t report[kPacketSize + 1];
+    report[0] = 0;
+    std::memcpy(report + 1, packet.bytes.data(), kPacketSize);
+    ssize_t n;
+    do {
+        n = ::write(fd_, report, sizeof report);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0)
+        throw TransportError(errno_message("write to " + path_));
+    if (static_cast<size_t>(n) != sizeof report)
+        throw TransportError("short write to " + path_);
+    ++stats_.reports_written;
+}
+
+bool HidrawTransport::read(Packet& packet, std::chrono::milliseconds timeout) {
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready;
+    do {
+        ready = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    } while (ready < 0 && errno == EINTR);
+    if (ready < 0)
+        throw TransportError(errno_message("poll on " + path_));
+    if (ready == 0)
+        return false;
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+        throw TransportError(path_ + " went away");
+
+    ssize_t n = ::read(fd_, packet.bytes.data(), kPacketSize);
+    if (n < 0)
+        throw TransportError(errno_message("read from " + path_));
+    if (static_cast<size_t>(n) != kPacketSize)
+        throw TransportError("unexpected report size from " + path_);
+    ++stats_.reports_read;
+    return true;
+}
+
+}  // namespace sk28a
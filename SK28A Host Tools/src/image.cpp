@@ -0,0 +1,699 @@
+#include "sk28a/image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "sk28a/protocol.h"
+
+namespace sk28a {
+
+void Image::write(uint32_t address, const uint8_t* data, size_t size) {
+    if (size == 0)
+        return;
+    uint32_t begin = address;
+    uint32_t end = address + static_cast<uint32_t>(size);
+
+    // Every segment that overlaps or touches [begin, end) gets merged into one
+    auto first = segments_.upper_bound(begin);
+    if (first != segments_.begin()) {
+        auto prev = std::prev(first);
+        if (prev->first + prev->second.size() >= begin)
+            first = prev;
+    }
+    auto last = first;
+    uint32_t merged_begin = begin;
+    uint32_t merged_end = end;
+    for (; last != segments_.end() && last->first <= end; ++last) {
+        merged_begin = std::min(merged_begin, last->first);
+        merged_end = std::max(merged_end, last->first + static_cast<uint32_t>(last->second.size()));
+    }
+
+    std::vector<uint8_t> merged(merged_end - merged_begin);
+    for (auto it = first; it != last; ++it)
+        std::copy(it->second.begin(), it->second.end(), merged.begin() + (it->first - merged_begin));
+    std::copy(data, data + size, merged.begin() + (begin - merged_begin));
+
+    segments_.erase(first, last);
+    segments_.emplace(merged_begin, std::move(merged));
+}
+
+size_t Image::byte_count() const {
+    size_t n = 0;
+    for (const auto& seg : segments_)
+        n += seg.second.size();
+    return n;
+}
+
+Image Image::slice(uint32_t begin, uint32_t end) const {
+    Image out;
+    for (const auto& [start, bytes] : segments_) {
+        uint32_t seg_end = start + static_cast<uint32_t>(bytes.size());
+        uint32_t b = std::max(begin, start);
+        uint32_t e = std::min(end, seg_end);
+        if (b < e)
+            out.segments_.emplace(b, std::vector<uint8_t>(bytes.begin() + (b - start), bytes.begin() + (e - start)));
+    }
+    return out;
+}
+
+Image Image::without_blank_blocks(uint32_t block_size, uint32_t begin, uint32_t end, unsigned min_run) const {
+    return ImageView(*this).without_blank_blocks(block_size, begin, end, min_run).to_image();
+}
+
+namespace {
+
+// Adds a run after the last one, joining the two if it carries on from it in memory as well as in address
+void append(std::vector<ImageView::Run>& runs, const ImageView::Run& run) {
+    if (run.size == 0)
+        return;
+    if (!runs.empty() && runs.back().end() == run.address && runs.back().data + runs.back().size == run.data)
+        runs.back().size += run.size;
+    else
+        runs.push_back(run);
+}
+
+}  // namespace
+
+ImageView::ImageView(const Image& image) {
+    runs_.reserve(image.segments().size());
+    for (const auto& [address, bytes] : image.segments())
+        runs_.push_back(Run{address, bytes.data(), bytes.size()});
+}
+
+size_t ImageView::byte_count() const {
+    size_t n = 0;
+    for (const Run& run : runs_)
+        n += run.size;
+    return n;
+}
+
+ImageView ImageView::slice(uint32_t begin, uint32_t end) const {
+    return slices({{begin, end}});
+}
+
+ImageView ImageView::slices(std::vector<std::pair<uint32_t, uint32_t>> ranges) const {
+    std::sort(ranges.begin(), ranges.end());
+    ImageView out;
+    out.file_ = file_;
+    out.written_ = written_;
+    out.owned_ = owned_;
+    for (const auto& [begin, end] : ranges) {
+        auto it = std::partition_point(runs_.begin(), runs_.end(), [&](const Run& run) { return run.end() <= begin; });
+        for (; it != runs_.end() && it->address < end; ++it) {
+            const uint32_t b = std::max(begin, it->address);
+            const uint32_t e = std::min(end, it->end());
+            if (b < e)
+                append(out.runs_, Run{b, it->data + (b - it->address), e - b});
+        }
+    }
+    return out;
+}
+
+ImageView ImageView::without_blank_blocks(uint32_t block_size, uint32_t begin, uint32_t end, unsigned min_run) const {
+    struct Chunk {
+        size_t offset;
+        size_t size;
+        bool blank;
+    };
+    ImageView out;
+    out.file_ = file_;
+    out.written_ = written_;
+    out.owned_ = owned_;
+    std::vector<Chunk> chunks;
+    for (const Run& run : runs_) {
+        // The run cut at block boundaries
+        chunks.clear();
+        for (size_t at = 0; at < run.size;) {
+            const uint32_t address = run.address + static_cast<uint32_t>(at);
+            const size_t n = std::min<size_t>(run.size - at, block_size - address % block_size);
+            const bool blank = address >= begin && address + n <= end &&
+                               std::all_of(run.data + at, run.data + at + n, [](uint8_t b) { return b == 0xFF; });
+            chunks.push_back({at, n, blank});
+            at += n;
+        }
+
+        auto keep = [&](size_t from, size_t to) {
+            if (from < to)
+                out.runs_.push_back(Run{run.address + static_cast<uint32_t>(from), run.data + from, to - from});
+        };
+        size_t piece = 0;  // Start of the part not yet kept or dropped
+        for (size_t i = 0; i < chunks.size();) {
+            if (!chunks[i].blank) {
+                ++i;
+                continue;
+            }
+            size_t j = i;
+            while (j < chunks.size() && chunks[j].blank)
+                ++j;
+            if (i == 0 || j == chunks.size() || j - i >= min_run) {
+                keep(piece, chunks[i].offset);
+                piece = chunks[j - 1].offset + chunks[j - 1].size;
+            }
+            i = j;
+        }
+        keep(piece, run.size);
+    }
+    return out;
+}
+
+ImageView ImageView::with(uint32_t address, const uint8_t* data, size_t size) const {
+    if (size == 0)
+        return *this;
+    const uint32_t end = address + static_cast<uint32_t>(size);
+    // Every run that overlaps or touches [address, end) goes into one, as with Image::write()
+    auto first = std::partition_point(runs_.begin(), runs_.end(), [&](const Run& run) { return run.end() < address; });
+    auto last = first;
+    uint32_t merged_begin = address;
+    uint32_t merged_end = end;
+    for (; last != runs_.end() && last->address <= end; ++last) {
+        merged_begin = std::min(merged_begin, last->address);
+        merged_end = std::max(merged_end, last->end());
+    }
+    auto merged = std::make_shared<std::vector<uint8_t>>(merged_end - merged_begin);
+    for (auto it = first; it != last; ++it)
+        std::copy(it->data, it->data + it->size, merged->begin() + (it->address - merged_begin));
+    std::copy(data, data + size, merged->begin() + (address - merged_begin));
+
+    ImageView out;
+    out.file_ = file_;
+    out.written_ = written_;
+    out.written_.emplace_back(address, end);
+    out.owned_ = owned_;
+    out.owned_.push_back(merged);
+    out.runs_.assign(runs_.begin(), first);
+    out.runs_.push_back(Run{merged_begin, merged->data(), merged->size()});
+    out.runs_.insert(out.runs_.end(), last, runs_.end());
+    return out;
+}
+
+bool ImageView::stored_row(uint32_t address, uint16_t& crc, uint64_t& present) const {
+    if (file_ == nullptr)
+        return false;
+    for (const auto& [begin, end] : written_) {
+        if (begin < address + kEraseRowSize && end > address)
+            return false;
+    }
+    const std::optional<ImageFile::Row> row = file_->find_row(address);
+    if (!row)
+        return false;
+    crc = row->crc;
+    present = row->present;
+    return true;
+}
+
+Image ImageView::to_image() const {
+    Image image;
+    for (const Run& run : runs_)
+        image.write(run.address, run.data, run.size);
+    return image;
+}
+
+namespace {
+
+// Turns pages with a mask of the bytes present into maximal runs.  Pages aren't contiguous in memory, so a
+// run is collected here before it goes into the image.
+class RunCollector {
+public:
+    explicit RunCollector(Image& image) : image_(image) {}
+
+    void add(uint32_t address, const uint8_t* bytes, uint64_t present, uint32_t size) {
+        if (size < 64)
+            present &= (uint64_t{1} << size) - 1;
+        while (present != 0) {
+            // The next run of set bits, [b, e)
+            const unsigned b = static_cast<unsigned>(__builtin_ctzll(present));
+            const uint64_t from_b = ~present >> b;
+            const unsigned e = from_b == 0 ? 64 : b + static_cast<unsigned>(__builtin_ctzll(from_b));
+            if (!run_.empty() && start_ + run_.size() != address + b)
+                flush();
+            if (run_.empty())
+                start_ = address + b;
+            run_.insert(run_.end(), bytes + b, bytes + e);
+            present = e == 64 ? 0 : present & (~uint64_t{0} << e);
+        }
+    }
+
+    void flush() {
+        if (!run_.empty())
+            image_.write(start_, run_.data(), run_.size());
+        run_.clear();
+    }
+
+private:
+    Image& image_;
+    uint32_t start_ = 0;
+    std::vector<uint8_t> run_;
+};
+
+}  // namespace
+
+PageMap::PageMap(uint32_t page_size) : page_size_(page_size) {
+    if (page_size == 0 || page_size > 64 || (page_size & (page_size - 1)) != 0)
+        throw std::invalid_argument("page size must be a power of two up to 64");
+}
+
+size_t PageMap::find_or_add(uint32_t page_address) {
+    // Hex files are written in ascending order: the same page as last time, or the next one
+    if (last_ < index_.size() && index_[last_].address == page_address)
+        return last_;
+    if (last_ + 1 < index_.size() && index_[last_ + 1].address == page_address)
+        return ++last_;
+
+    auto it = std::lower_bound(index_.begin(), index_.end(), page_address,
+                               [](const Slot& slot, uint32_t a) { return slot.address < a; });
+    if (it == index_.end() || it->address != page_address) {
+        it = index_.insert(it, Slot{page_address, static_cast<uint32_t>(present_.size())});
+        bytes_.resize(bytes_.size() + page_size_, 0xFF);
+        present_.push_back(0);
+    }
+    last_ = static_cast<size_t>(it - index_.begin());
+    return last_;
+}
+
+void PageMap::write(uint32_t address, const uint8_t* data, size_t size) {
+    while (size != 0) {
+        const uint32_t at = address % page_size_;
+        const size_t n = std::min<size_t>(size, page_size_ - at);
+        const uint32_t pool = index_[find_or_add(address - at)].pool_index;
+        std::memcpy(&bytes_[static_cast<size_t>(pool) * page_size_ + at], data, n);
+        present_[pool] |= (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << at;
+        address += static_cast<uint32_t>(n);
+        data += n;
+        size -= n;
+    }
+}
+
+size_t PageMap::byte_count() const {
+    size_t n = 0;
+    for (const uint64_t present : present_)
+        n += std::bitset<64>(present).count();
+    return n;
+}
+
+PageMap::Page PageMap::page(size_t i) const {
+    const Slot& slot = index_[i];
+    return Page{slot.address, &bytes_[static_cast<size_t>(slot.pool_index) * page_size_], present_[slot.pool_index]};
+}
+
+Image PageMap::to_image() const {
+    Image image;
+    RunCollector runs(image);
+    for (size_t i = 0; i < index_.size(); ++i) {
+        const Page p = page(i);
+        runs.add(p.address, p.bytes, p.present, page_size_);
+    }
+    runs.flush();
+    return image;
+}
+
+namespace {
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+}  // namespace
+
+void scan_hex(std::string_view text, const std::string& name, const HexDataCallback& on_data) {
+    uint32_t upper = 0;  // From type 02/04 records
+    size_t line_no = 0;
+    bool saw_eof = false;
+
+    auto fail = [&](const std::string& why) -> HexError {
+        return HexError(name + ":" + std::to_string(line_no) + ": " + why);
+    };
+
+    size_t pos = 0;
+    while (pos < text.size() && !saw_eof) {
+        size_t eol = text.find('\n', pos);
+        std::string_view line = text.substr(pos, eol == std::string_view::npos ? std::string_view::npos : eol - pos);
+        pos = eol == std::string_view::npos ? text.size() : eol + 1;
+        ++line_no;
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+            line.remove_suffix(1);
+        if (line.empty())
+            continue;
+        if (line[0] != ':')
+            throw fail("record does not start with ':'");
+        if (line.size() < 11 || (line.size() - 1) % 2 != 0)
+            throw fail("malformed record");
+
+        uint8_t record[255 + 5];
+        size_t count = (line.size() - 1) / 2;
+        if (count > sizeof record)
+            throw fail("record too long");
+        uint8_t sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            int hi = hex_digit(line[1 + 2 * i]);
+            int lo = hex_digit(line[2 + 2 * i]);
+            if (hi < 0 || lo < 0)
+                throw fail("invalid hex digit");
+            record[i] = static_cast<uint8_t>(hi << 4 | lo);
+            sum = static_cast<uint8_t>(sum + record[i]);
+        }
+        const uint8_t length = record[0];
+        if (count != static_cast<size_t>(length) + 5)
+            throw fail("byte count does not match record length");
+        if (sum != 0)
+            throw fail("checksum mismatch");
+
+        const uint16_t offset = static_cast<uint16_t>(record[1] << 8 | record[2]);
+        const uint8_t* data = record + 4;
+        switch (record[3]) {
+        case 0x00:
+            on_data(upper + offset, data, length);
+            break;
+        case 0x01:
+            saw_eof = true;
+            break;
+        case 0x02:
+            if (length != 2)
+                throw fail("bad extended segment address record");
+            upper = static_cast<uint32_t>(data[0] << 8 | data[1]) << 4;
+            break;
+        case 0x04:
+            if (length != 2)
+                throw fail("bad extended linear address record");
+            upper = static_cast<uint32_t>(data[0] << 8 | data[1]) << 16;
+            break;
+        case 0x03:
+        case 0x05:
+            break;  // Start address, meaningless for the PIC
+        default:
+            throw fail("unknown record type");
+        }
+    }
+    if (!saw_eof)
+        throw HexError(name + ": missing end of file record");
+}
+
+Image parse_hex(std::string_view text, const std::string& name) {
+    PageMap pages;
+    scan_hex(text, name, [&](uint32_t address, const uint8_t* data, size_t size) { pages.write(address, data, size); });
+    return pages.to_image();
+}
+
+// Read-only mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : path_(path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw ImageError("cannot open " + path + ": " + std::strerror(errno));
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int e = errno;
+            ::close(fd);
+            throw ImageError("cannot stat " + path + ": " + std::strerror(e));
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ != 0) {
+            data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data_ == MAP_FAILED) {
+                const int e = errno;
+                ::close(fd);
+                throw ImageError("cannot map " + path + ": " + std::strerror(e));
+            }
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+    ~MappedFile() {
+        if (size_ != 0)
+            ::munmap(data_, size_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    const uint8_t* data() const { return static_cast<const uint8_t*>(data_); }
+    size_t size() const { return size_; }
+    std::string_view text() const { return {static_cast<const char*>(data_), size_}; }
+
+private:
+    std::string path_;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+Image read_hex_file(const std::string& path) {
+    const MappedFile file(path);
+    return parse_hex(file.text(), path);
+}
+
+namespace {
+
+// .sk28img layout, see image.h
+constexpr char kImageMagic[8] = {'S', 'K', '2', '8', 'I', 'M', 'G', '\0'};
+constexpr uint16_t kImageVersion = 1;
+constexpr size_t kImageHeaderSize = 32;
+constexpr size_t kRegionEntrySize = 16;
+constexpr size_t kRowEntrySize = 16;
+constexpr size_t kRowSize = kEraseRowSize;
+
+// Header fields
+constexpr size_t kHeaderVersion = 8;
+constexpr size_t kHeaderRegionCount = 10;
+constexpr size_t kHeaderRowCount = 12;
+constexpr size_t kHeaderDataOffset = 16;
+constexpr size_t kHeaderRowSize = 20;
+constexpr size_t kHeaderCrc = 22;
+
+uint16_t get_u16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+
+uint32_t get_u32(const uint8_t* p) { return static_cast<uint32_t>(get_u16(p)) | static_cast<uint32_t>(get_u16(p + 2)) << 16; }
+
+uint64_t get_u64(const uint8_t* p) { return static_cast<uint64_t>(get_u32(p)) | static_cast<uint64_t>(get_u32(p + 4)) << 32; }
+
+void put_le(uint8_t* p, uint64_t v, size_t size) {
+    for (size_t i = 0; i < size; ++i)
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+// CRC of everything before the data, the CRC field counting as zero
+uint16_t header_crc(const uint8_t* file, size_t data_offset) {
+    const uint8_t zero[2] = {0, 0};
+    uint16_t crc = crc16_ccitt(file, kHeaderCrc);
+    crc = crc16_ccitt(zero, sizeof zero, crc);
+    return crc16_ccitt(file + kHeaderCrc + 2, data_offset - kHeaderCrc - 2, crc);
+}
+
+size_t popcount(uint64_t v) { return std::bitset<64>(v).count(); }
+
+}  // namespace
+
+RegionKind region_kind(uint32_t address) {
+    if (is_eeprom_address(address))
+        return RegionKind::Eeprom;
+    if (is_config_address(address))
+        return RegionKind::Config;
+    if (is_user_id_address(address))
+        return RegionKind::UserId;
+    return RegionKind::Program;
+}
+
+std::string to_string(RegionKind kind) {
+    switch (kind) {
+    case RegionKind::Program: return "program";
+    case RegionKind::Eeprom: return "EEPROM";
+    case RegionKind::Config: return "config";
+    case RegionKind::UserId: return "user ID";
+    }
+    return "region kind " + std::to_string(static_cast<unsigned>(kind));
+}
+
+std::vector<uint8_t> to_image_file(const Image& image) {
+    PageMap rows(kRowSize);
+    for (const auto& [address, bytes] : image.segments())
+        rows.write(address, bytes.data(), bytes.size());
+
+    struct Region {
+        RegionKind kind;
+        uint32_t first_row;
+        uint32_t row_count;
+        uint32_t byte_count;
+    };
+    std::vector<Region> regions;
+    for (size_t i = 0; i < rows.page_count(); ++i) {
+        const PageMap::Page row = rows.page(i);
+        const RegionKind kind = region_kind(row.address);
+        if (regions.empty() || regions.back().kind != kind)
+            regions.push_back(Region{kind, static_cast<uint32_t>(i), 0, 0});
+        ++regions.back().row_count;
+        regions.back().byte_count += static_cast<uint32_t>(popcount(row.present));
+    }
+
+    const size_t table_end = kImageHeaderSize + regions.size() * kRegionEntrySize + rows.page_count() * kRowEntrySize;
+    const size_t data_offset = (table_end + kRowSize - 1) / kRowSize * kRowSize;
+    std::vector<uint8_t> out(data_offset + rows.page_count() * kRowSize, 0);
+    std::memcpy(out.data(), kImageMagic, sizeof kImageMagic);
+    put_le(&out[kHeaderVersion], kImageVersion, 2);
+    put_le(&out[kHeaderRegionCount], regions.size(), 2);
+    put_le(&out[kHeaderRowCount], rows.page_count(), 4);
+    put_le(&out[kHeaderDataOffset], data_offset, 4);
+    put_le(&out[kHeaderRowSize], kRowSize, 2);
+
+    uint8_t* entry = &out[kImageHeaderSize];
+    for (const Region& r : regions) {
+        entry[0] = static_cast<uint8_t>(r.kind);
+        put_le(entry + 4, r.first_row, 4);
+        put_le(entry + 8, r.row_count, 4);
+        put_le(entry + 12, r.byte_count, 4);
+        entry += kRegionEntrySize;
+    }
+    for (size_t i = 0; i < rows.page_count(); ++i) {
+        const PageMap::Page row = rows.page(i);
+        uint8_t* data = &out[data_offset + i * kRowSize];
+        std::memcpy(data, row.bytes, kRowSize);
+        put_le(entry, row.address, 4);
+        put_le(entry + 4, crc16_ccitt(data, kRowSize), 2);
+        put_le(entry + 8, row.present, 8);
+        entry += kRowEntrySize;
+    }
+    put_le(&out[kHeaderCrc], header_crc(out.data(), data_offset), 2);
+    return out;
+}
+
+void write_image_file(const Image& image, const std::string& path) {
+    const std::vector<uint8_t> bytes = to_image_file(image);
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr)
+        throw ImageError("cannot write " + path + ": " + std::strerror(errno));
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok)
+        throw ImageError("cannot write " + path + ": " + std::strerror(errno));
+}
+
+ImageFile::ImageFile(const std::string& path) : file_(std::make_unique<MappedFile>(path)) {
+    auto fail = [&](const std::string& why) { return ImageError(path + ": " + why); };
+    const uint8_t* data = file_->data();
+    const size_t size = file_->size();
+    if (size < kImageHeaderSize || std::memcmp(data, kImageMagic, sizeof kImageMagic) != 0)
+        throw fail("not an .sk28img file");
+    if (get_u16(data + kHeaderVersion) != kImageVersion)
+        throw fail("unsupported .sk28img version " + std::to_string(get_u16(data + kHeaderVersion)));
+    if (get_u16(data + kHeaderRowSize) != kRowSize)
+        throw fail("unsupported row size " + std::to_string(get_u16(data + kHeaderRowSize)));
+
+    const size_t region_count = get_u16(data + kHeaderRegionCount);
+    row_count_ = get_u32(data + kHeaderRowCount);
+    const uint64_t data_offset = get_u32(data + kHeaderDataOffset);
+    const uint64_t table_end = kImageHeaderSize + uint64_t{region_count} * kRegionEntrySize + uint64_t{row_count_} * kRowEntrySize;
+    if (data_offset % kRowSize != 0 || data_offset < table_end || data_offset + uint64_t{row_count_} * kRowSize != size)
+        throw fail("truncated or inconsistent file");
+    if (get_u16(data + kHeaderCrc) != header_crc(data, data_offset))
+        throw fail("header CRC mismatch");
+    rows_ = data + kImageHeaderSize + region_count * kRegionEntrySize;
+    row_data_ = data + data_offset;
+
+    uint32_t next_row = 0;
+    for (size_t i = 0; i < region_count; ++i) {
+        const uint8_t* entry = data + kImageHeaderSize + i * kRegionEntrySize;
+        const Region r{static_cast<RegionKind>(entry[0]), get_u32(entry + 4), get_u32(entry + 8), get_u32(entry + 12)};
+        if (r.first_row != next_row || r.row_count > row_count_ - next_row)
+            throw fail("regions don't cover the rows in order");
+        next_row += r.row_count;
+
+        size_t bytes = 0;
+        for (uint32_t n = r.first_row; n < r.first_row + r.row_count; ++n) {
+            const Row row = this->row(n);
+            if (row.address % kRowSize != 0 || (n != 0 && row.address <= this->row(n - 1).address))
+                throw fail("rows out of order at row " + std::to_string(n));
+            if (region_kind(row.address) != r.kind)
+                throw fail("row at " + std::to_string(row.address) + " outside its " + to_string(r.kind) + " region");
+            if (crc16_ccitt(row.bytes, kRowSize) != row.crc)
+                throw fail("CRC mismatch in row " + std::to_string(n));
+            bytes += popcount(row.present);
+        }
+        if (bytes != r.byte_count)
+            throw fail("byte count mismatch in the " + to_string(r.kind) + " region");
+        regions_.push_back(r);
+    }
+    if (next_row != row_count_)
+        throw fail("regions don't cover the rows in order");
+}
+
+ImageFile::~ImageFile() = default;
+
+ImageFile::Row ImageFile::row(size_t i) const {
+    const uint8_t* entry = rows_ + i * kRowEntrySize;
+    return Row{get_u32(entry), get_u16(entry + 4), get_u64(entry + 8), row_data_ + i * kRowSize};
+}
+
+std::optional<ImageFile::Row> ImageFile::find_row(uint32_t address) const {
+    size_t lo = 0;
+    size_t hi = row_count_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const uint32_t a = get_u32(rows_ + mid * kRowEntrySize);
+        if (a == address)
+            return row(mid);
+        if (a < address)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return std::nullopt;
+}
+
+Image ImageFile::to_image() const { return ImageView(*this).to_image(); }
+
+ImageView::ImageView(const ImageFile& file) : file_(&file) {
+    // Rows at consecutive addresses are consecutive in the mapping too, so runs carry on from one row into the next
+    for (size_t i = 0; i < file.row_count(); ++i) {
+        const ImageFile::Row r = file.row(i);
+        for (uint64_t present = r.present; present != 0;) {
+            // The next run of set bits, [b, e)
+            const unsigned b = static_cast<unsigned>(__builtin_ctzll(present));
+            const uint64_t from_b = ~present >> b;
+            const unsigned e = from_b == 0 ? 64 : b + static_cast<unsigned>(__builtin_ctzll(from_b));
+            append(runs_, Run{r.address + b, r.bytes + b, e - b});
+            present = e == 64 ? 0 : present & (~uint64_t{0} << e);
+        }
+    }
+}
+
+bool is_image_file(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    char magic[sizeof kImageMagic];
+    const bool match = ::read(fd, magic, sizeof magic) == static_cast<ssize_t>(sizeof magic) &&
+                       std::memcmp(magic, kImageMagic, sizeof magic) == 0;
+    ::close(fd);
+    return match;
+}
+
+Image read_image(const std::string& path) {
+    if (is_image_file(path))
+        return ImageFile(path).to_image();
+    return read_hex_file(path);
+}
+
+ImageSource::ImageSource(const std::string& path) {
+    if (is_image_file(path)) {
+        file_ = std::make_unique<const ImageFile>(path);
+        view_ = *file_;
+    } else {
+        image_ = read_hex_file(path);
+        view_ = image_;
+    }
+}
+
+}  // namespace sk28a
@@ -0,0 +1,99 @@
+#include "sk28a/journal.h"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+
+namespace sk28a {
+
+namespace {
+
+constexpr char kMagic[] = "sk28a-journal";
+constexpr unsigned kVersion = 1;
+
+}  // namespace
+
+uint64_t fingerprint(const ImageView& image) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    auto add = [&h](uint8_t b) {
+        h ^= b;
+        h *= 0x100000001B3ull;
+    };
+    for (const ImageView::Run& run : image.runs()) {
+        for (int shift = 0; shift < 32; shift += 8)
+            add(static_cast<uint8_t>(run.address >> shift));
+        for (size_t i = 0; i < run.size; ++i)
+            add(run.data[i]);
+    }
+    return h;
+}
+
+Journal::~Journal() { close(); }
+
+void Journal::close() {
+    if (file_ != nullptr)
+        std::fclose(file_);
+    file_ = nullptr;
+}
+
+uint32_t Journal::load(uint64_t image_fingerprint) const {
+    std::FILE* f = std::fopen(path_.c_str(), "r");
+    if (f == nullptr)
+        return 0;
+    char line[64];
+    uint32_t done = 0;
+    unsigned version = 0;
+    uint64_t fp = 0;
+    if (std::fgets(line, sizeof line, f) != nullptr &&
+        std::sscanf(line, "sk28a-journal %u %" SCNx64, &version, &fp) == 2 && version == kVersion &&
+        fp == image_fingerprint) {
+        // A line without its newline is one the last run didn't get to finish
+        while (std::fgets(line, sizeof line, f) != nullptr) {
+            unsigned address;
+            char end;
+            if (std::sscanf(line, "0x%x%c", &address, &end) == 2 && end == '\n')
+                done = address;
+        }
+    }
+    std::fclose(f);
+    return done;
+}
+
+void Journal::start(uint64_t image_fingerprint, uint32_t done) {
+    close();
+    // Written aside and renamed over the old one, so there is always one journal or the other
+    const std::string temp = path_ + ".new";
+    std::FILE* f = std::fopen(temp.c_str(), "w");
+    if (f == nullptr)
+        throw JournalError("cannot write " + path_ + ": " + std::strerror(errno));
+    std::fprintf(f, "%s %u %016" PRIX64 "\n", kMagic, kVersion, image_fingerprint);
+    if (done != 0)
+        std::fprintf(f, "0x%06X\n", done);
+    const bool ok = std::fflush(f) == 0;
+    const int e = errno;
+    std::fclose(f);
+    if (!ok || std::rename(temp.c_str(), path_.c_str()) != 0) {
+        const int err = ok ? errno : e;
+        std::remove(temp.c_str());
+        throw JournalError("cannot write " + path_ + ": " + std::strerror(err));
+    }
+    file_ = std::fopen(path_.c_str(), "a");
+    if (file_ == nullptr)
+        throw JournalError("cannot write " + path_ + ": " + std::strerror(errno));
+}
+
+void Journal::commit(uint32_t done) {
+    if (file_ == nullptr)
+        throw JournalError(path_ + " has not been started");
+    // The board is what tends to go away, not the host, so the line isn't synced to disk
+    if (std::fprintf(file_, "0x%06X\n", done) < 0 || std::fflush(file_) != 0)
+        throw JournalError("cannot write " + path_ + ": " + std::strerror(errno));
+}
+
+void Journal::remove() {
+    close();
+    if (std::remove(path_.c_str()) != 0 && errno != ENOENT)
+        throw JournalError("cannot remove " + path_ + ": " + std::strerror(errno));
+}
+
+}  // namespace sk28a
@@ -0,0 +1,151 @@
+#include "sk28a/libusb_transport.h"
+
+#include <libusb.h>
+
+#include <algorithm>
+
+namespace sk28a {
+
+namespace {
+
+// The firmware NAKs while it erases or writes flash, but services the bus in between
+constexpr unsigned kWriteTimeoutMs = 5000;
+
+std::string libusb_message(const std::string& what, int error) {
+    return what + ": " + libusb_strerror(static_cast<libusb_error>(error));
+}
+
+std::string device_path(libusb_device* dev) {
+    uint8_t ports[8];
+    const int n = libusb_get_port_numbers(dev, ports, sizeof ports);
+    std::string path = "usb:" + std::to_string(libusb_get_bus_number(dev));
+    for (int i = 0; i < n; ++i)
+        path += (i == 0 ? "-" : ".") + std::to_string(ports[i]);
+    return path;
+}
+
+bool has_vendor_interface(libusb_device* dev) {
+    libusb_config_descriptor* config;
+    if (libusb_get_config_descriptor(dev, 0, &config) != 0)
+        return false;
+    const bool vendor = config->bNumInterfaces > 0 && config->interface[0].num_altsetting > 0 &&
+                        config->interface[0].altsetting[0].bInterfaceClass == kVendorInterfaceClass;
+    libusb_free_config_descriptor(config);
+    return vendor;
+}
+
+// Calls f(dev, descriptor) for each vendor class device matching vendor_id:product_id
+template <typename F>
+void for_each_device(libusb_context* context, uint16_t vendor_id, uint16_t product_id, F f) {
+    libusb_device** list;
+    const ssize_t count = libusb_get_device_list(context, &list);
+    if (count < 0)
+        throw TransportError(libusb_message("cannot list USB devices", static_cast<int>(count)));
+    for (ssize_t i = 0; i < count; ++i) {
+        libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(list[i], &desc) != 0 || desc.idVendor != vendor_id ||
+            desc.idProduct != product_id || !has_vendor_interface(list[i]))
+            continue;
+        if (!f(list[i], desc))
+            break;
+    }
+    libusb_free_device_list(list, 1);
+}
+
+}  // namespace
+
+std::vector<LibusbDevice> find_libusb_devices(uint16_t vendor_id, uint16_t product_id) {
+    std::vector<LibusbDevice> found;
+    libusb_context* context;
+    if (libusb_init(&context) != 0)
+        return found;
+    for_each_device(context, vendor_id, product_id, [&](libusb_device* dev, const libusb_device_descriptor& desc) {
+        LibusbDevice d;
+        d.path = device_path(dev);
+        d.phys = d.path;
+        libusb_device_handle* handle;
+        if (desc.iSerialNumber != 0 && libusb_open(dev, &handle) == 0) {
+            unsigned char serial[64];
+            const int n = libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, serial, sizeof serial);
+            if (n > 0)
+                d.uniq.assign(reinterpret_cast<const char*>(serial), static_cast<size_t>(n));
+            libusb_close(handle);
+        }
+        found.push_back(d);
+        return true;
+    });
+    libusb_exit(context);
+    std::sort(found.begin(), found.end(), [](const LibusbDevice& a, const LibusbDevice& b) { return a.path < b.path; });
+    return found;
+}
+
+LibusbTransport::LibusbTransport(const std::string& path) : path_(path) {
+    int r = libusb_init(&context_);
+    if (r != 0)
+        throw TransportError(libusb_message("cannot initialise libusb", r));
+    libusb_device* device = nullptr;
+    try {
+        for_each_device(context_, kVendorId, kProductId, [&](libusb_device* dev, const libusb_device_descriptor&) {
+            if (device_path(dev) != path)
+                return true;
+            device = libusb_ref_device(dev);
+            return false;
+        });
+    } catch (...) {
+        libusb_exit(context_);
+        throw;
+    }
+    if (device == nullptr) {
+        libusb_exit(context_);
+        throw TransportError("no vendor class bootloader at " + path);
+    }
+    r = libusb_open(device, &handle_);
+    libusb_unref_device(device);
+    if (r == 0) {
+        libusb_set_auto_detach_kernel_driver(handle_, 1);
+        r = libusb_claim_interface(handle_, 0);
+        if (r != 0) {
+            libusb_close(handle_);
+            handle_ = nullptr;
+        }
+    }
+    if (r != 0) {
+        libusb_exit(context_);
+        throw TransportError(libusb_message("cannot open " + path, r));
+    }
+}
+
+LibusbTransport::~LibusbTransport() {
+    libusb_release_interface(handle_, 0);
+    libusb_close(handle_);
+    libusb_exit(context_);
+}
+
+void LibusbTransport::write(const Packet& packet) {
+    Packet out = packet;  // libusb takes a non-const buffer
+    int written = 0;
+    const int r = libusb_bulk_transfer(handle_, kBulkOutEndpoint, out.bytes.data(), kPacketSize, &written,
+                                       kWriteTimeoutMs);
+    if (r != 0)
+        throw TransportError(libusb_message("write to " + path_, r));
+    if (static_cast<size_t>(written) != kPacketSize)
+        throw TransportError("short write to " + path_);
+    ++stats_.reports_written;
+}
+
+bool LibusbTransport::read(Packet& packet, std::chrono::milliseconds timeout) {
+    int received = 0;
+    const int r = libusb_bulk_transfer(handle_, kBulkInEndpoint, packet.bytes.data(), kPacketSize, &received,
+                                       static_cast<unsigned>(std::max<long long>(1, timeout.count())));
+    // A packet can still land as the transfer times out
+    if (r == LIBUSB_ERROR_TIMEOUT && received == 0)
+        return false;
+    if (r != 0 && r != LIBUSB_ERROR_TIMEOUT)
+        throw TransportError(libusb_message("read from " + path_, r));
+    if (static_cast<size_t>(received) != kPacketSize)
+        throw TransportError("unexpected packet size from " + path_);
+    ++stats_.reports_read;
+    return true;
+}
+
+}  // namespace sk28a
@@ -0,0 +1,273 @@
+#include "sk28a/protocol.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace sk28a {
+
+uint16_t Packet::u16(size_t at) const {
+    return static_cast<uint16_t>(bytes[at] | (bytes[at + 1] << 8));
+}
+
+uint32_t Packet::u32(size_t at) const {
+    return static_cast<uint32_t>(bytes[at]) | (static_cast<uint32_t>(bytes[at + 1]) << 8) |
+           (static_cast<uint32_t>(bytes[at + 2]) << 16) | (static_cast<uint32_t>(bytes[at + 3]) << 24);
+}
+
+void Packet::set_u16(size_t at, uint16_t v) {
+    bytes[at] = static_cast<uint8_t>(v);
+    bytes[at + 1] = static_cast<uint8_t>(v >> 8);
+}
+
+void Packet::set_u32(size_t at, uint32_t v) {
+    for (size_t i = 0; i < 4; ++i)
+        bytes[at + i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+Packet make_command(Command command) {
+    Packet p;
+    p.bytes[offset::kCommand] = static_cast<uint8_t>(command);
+    return p;
+}
+
+Packet make_data_packet(Command command, uint32_t address, const uint8_t* data, size_t size) {
+    if (size > kDataBlockSize)
+        throw ProtocolError("data packet larger than RequestDataBlockSize");
+    Packet p = make_command(command);
+    p.set_u32(offset::kAddress, address);
+    p.set_u8(offset::kSize, static_cast<uint8_t>(size));
+    std::memcpy(p.bytes.data() + offset::kData + kDataBlockSize - size, data, size);
+    return p;
+}
+
+Packet make_get_data(uint32_t address, uint8_t size) {
+    Packet p = make_command(Command::GetData);
+    p.set_u32(offset::kAddress, address);
+    p.set_u8(offset::kSize, size);
+    return p;
+}
+
+Packet make_range(Command command, uint32_t address, uint32_t length) {
+    Packet p = make_command(command);
+    p.set_u32(offset::kAddress, address);
+    p.set_u32(offset::kLength, length);
+    return p;
+}
+
+Packet make_unlock_config(bool unlock) {
+    Packet p = make_command(Command::UnlockConfig);
+    p.set_u8(offset::kLockValue, unlock ? kUnlockConfig : kLockConfig);
+    return p;
+}
+
+size_t packbits_encode(const uint8_t* data, size_t size, size_t max_size, std::vector<uint8_t>& out) {
+    constexpr size_t kMaxRun = 128;
+    auto run_length = [&](size_t at) {
+        size_t n = 1;
+        while (at + n < size && n < kMaxRun && data[at + n] == data[at])
+            ++n;
+        return n;
+    };
+
+    out.clear();
+    size_t at = 0;
+    while (at < size && out.size() + 2 <= max_size) {
+        // Runs of two stay in the literal around them, where they cost no more and don't split it
+        const size_t run = run_length(at);
+        if (run >= 3) {
+            out.push_back(static_cast<uint8_t>(257 - run));
+            out.push_back(data[at]);
+            at += run;
+            continue;
+        }
+        const size_t room = std::min(kMaxRun, max_size - out.size() - 1);
+        size_t n = 1;
+        while (n < room && at + n < size && run_length(at + n) < 3)
+            ++n;
+        out.push_back(static_cast<uint8_t>(n - 1));
+        out.insert(out.end(), data + at, data + at + n);
+        at += n;
+    }
+    return at;
+}
+
+const MemoryRegion* DeviceInfo::region_at(uint32_t address) const {
+    for (const MemoryRegion& r : regions) {
+        if (r.contains(address))
+            return &r;
+    }
+    return nullptr;
+}
+
+DeviceInfo parse_query_response(const Packet& response) {
+    if (response.command() != Command::QueryDevice)
+        throw ProtocolError("expected a QUERY_DEVICE response, got " + to_string(response.command()));
+
+    DeviceInfo info;
+    info.packet_data_field_size = response.u8(1);
+    info.bytes_per_address = response.u8(2);
+    // Up to six (Type, Address, Length) entries, terminated by TypeEndOfTypeList
+    size_t at = 3;
+    for (int i = 0; i < 6; ++i, at += 9) {
+        const auto type = static_cast<MemoryType>(response.u8(at));
+        if (type == MemoryType::EndOfList)
+            break;
+        info.regions.push_back({type, response.u32(at + 1), response.u32(at + 5)});
+    }
+    info.extended_features = response.u16(3 + 6 * 9);
+    if (info.packet_data_field_size == 0 || info.packet_data_field_size > kDataBlockSize)
+        throw ProtocolError("QUERY_DEVICE response has an invalid PacketDataFieldSize");
+    return info;
+}
+
+EraseStatus parse_status_response(const Packet& response) {
+    if (response.command() != Command::GetEraseStatus)
+        throw ProtocolError("expected a GET_ERASE_STATUS response, got " + to_string(response.command()));
+    EraseStatus s;
+    s.busy = (response.u8(1) & kStatusEraseBusy) != 0;
+    s.pages_done = response.u16(2);
+    s.pages_remaining = response.u16(4);
+    s.pages_erased = response.u16(6);
+    return s;
+}
+
+bool parse_serial_number(const std::string& text, UserId& id) {
+    if (text.empty() || text.size() > 2 * kUserIdSize)
+        return false;
+    id.fill(0);
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[text.size() - 1 - i];
+        uint8_t digit;
+        if (c >= '0' && c <= '9')
+            digit = static_cast<uint8_t>(c - '0');
+        else if (c >= 'A' && c <= 'F')
+            digit = static_cast<uint8_t>(c - 'A' + 10);
+        else if (c >= 'a' && c <= 'f')
+            digit = static_cast<uint8_t>(c - 'a' + 10);
+        else
+            return false;
+        id[kUserIdSize - 1 - i / 2] |= static_cast<uint8_t>(i % 2 == 0 ? digit : digit << 4);
+    }
+    return true;
+}
+
+std::string serial_number(const UserId& id) {
+    // Same digits as BuildSerialNumberString() in the firmware
+    std::string s;
+    for (const uint8_t b : id) {
+        char digits[3];
+        std::snprintf(digits, sizeof digits, "%02X", b);
+        s += digits;
+    }
+    return s;
+}
+
+UserId next_serial_number(UserId id) {
+    for (size_t i = kUserIdSize; i-- > 0;) {
+        if (++id[i] != 0)
+            break;
+    }
+    return id;
+}
+
+uint16_t crc16_ccitt(const uint8_t* data, size_t size, uint16_t crc) {
+    // Same byte-at-a-time formulation as CalculateRangeCRC() in the firmware
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t x = static_cast<uint8_t>(data[i] ^ (crc >> 8));
+        x ^= x >> 4;
+        crc = static_cast<uint16_t>((crc << 8) ^ (static_cast<uint16_t>(x) << 12) ^ (static_cast<uint16_t>(x) << 5) ^ x);
+    }
+    return crc;
+}
+
+namespace {
+
+// A linear map of 16 bit values over GF(2), as the images of the 16 bits
+using Crc16Matrix = std::array<uint16_t, 16>;
+
+uint16_t apply(const Crc16Matrix& m, uint16_t v) {
+    uint16_t out = 0;
+    for (unsigned i = 0; v != 0; ++i, v >>= 1) {
+        if (v & 1)
+            out ^= m[i];
+    }
+    return out;
+}
+
+Crc16Matrix square(const Crc16Matrix& m) {
+    Crc16Matrix out;
+    for (unsigned i = 0; i < 16; ++i)
+        out[i] = apply(m, m[i]);
+    return out;
+}
+
+// What running a CRC through `size` zero bytes does to it
+Crc16Matrix zeros_matrix(size_t size) {
+    Crc16Matrix byte;  // One zero byte: eight shifts of the register
+    for (unsigned i = 0; i < 16; ++i) {
+        auto v = static_cast<uint16_t>(1u << i);
+        for (int bit = 0; bit < 8; ++bit)
+            v = static_cast<uint16_t>((v & 0x8000) ? (v << 1) ^ 0x1021 : v << 1);
+        byte[i] = v;
+    }
+    Crc16Matrix out;
+    for (unsigned i = 0; i < 16; ++i)
+        out[i] = static_cast<uint16_t>(1u << i);
+    for (; size != 0; size >>= 1, byte = square(byte)) {
+        if (size & 1) {
+            for (uint16_t& column : out)
+                column = apply(byte, column);
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+uint16_t crc16_ccitt_combine(uint16_t crc_a, uint16_t crc_b, size_t size_b) {
+    // The CRC is linear in its starting value: B's CRC started from crc_a instead of 0xFFFF differs from crc_b by
+    // the difference of the two, run through B's worth of zero bytes.  Callers combine runs of one size (rows),
+    // so the matrix for it is kept.
+    thread_local size_t cached_size = 0;
+    thread_local Crc16Matrix cached = zeros_matrix(0);
+    if (size_b != cached_size) {
+        cached = zeros_matrix(size_b);
+        cached_size = size_b;
+    }
+    return static_cast<uint16_t>(crc_b ^ apply(cached, static_cast<uint16_t>(crc_a ^ 0xFFFF)));
+}
+
+std::string to_string(Command command) {
+    switch (command) {
+    case Command::QueryDevice: return "QUERY_DEVICE";
+    case Command::UnlockConfig: return "UNLOCK_CONFIG";
+    case Command::EraseDevice: return "ERASE_DEVICE";
+    case Command::ProgramDevice: return "PROGRAM_DEVICE";
+    case Command::ProgramComplete: return "PROGRAM_COMPLETE";
+    case Command::GetData: return "GET_DATA";
+    case Command::ResetDevice: return "RESET_DEVICE";
+    case Command::ReadStream: return "READ_STREAM";
+    case Command::VerifyRange: return "VERIFY_RANGE";
+    case Command::EraseRange: return "ERASE_RANGE";
+    case Command::ProgramCompressed: return "PROGRAM_COMPRESSED";
+    case Command::Fill: return "FILL";
+    case Command::PatchDevice: return "PATCH_DEVICE";
+    case Command::GetEraseStatus: return "GET_ERASE_STATUS";
+    }
+    char buf[16];
+    std::snprintf(buf, sizeof buf, "command 0x%02X", static_cast<unsigned>(command));
+    return buf;
+}
+
+std::string to_string(MemoryType type) {
+    switch (type) {
+    case MemoryType::Program: return "program";
+    case MemoryType::Eeprom: return "eeprom";
+    case MemoryType::Config: return "config";
+    case MemoryType::EndOfList: return "end";
+    }
+    return "unknown";
+}
+
+}  // namespace sk28a
@@ -0,0 +1,151 @@
+#include "sk28a/sim_device.h"
+
+#include <algorithm>
+
+namespace sk28a {
+
+namespace {
+
+constexpr uint32_t kInvalidAddress = 0xFFFFFFFF;
+
+}  // namespace
+
+SimDevice::SimDevice()
+    : flash_(kProgramEnd, 0xFF),
+      user_id_(kUserIdSize, 0xFF),
+      config_(kConfigSize, 0xFF),
+      eeprom_(kEepromSize, 0xFF),
+      programmed_pointer_(kInvalidAddress) {}
+
+uint8_t* SimDevice::locate(uint32_t address) {
+    if (address < kProgramEnd)
+        return &flash_[address];
+    if (address - kUserIdAddress < kUserIdSize)
+        return &user_id_[address - kUserIdAddress];
+    if (address - kConfigAddress < kConfigSize)
+        return &config_[address - kConfigAddress];
+    if (address - kEepromAddress < kEepromSize)
+        return &eeprom_[address - kEepromAddress];
+    return nullptr;
+}
+
+uint8_t SimDevice::peek(uint32_t address) const {
+    // Unimplemented config bytes read back as 0xFF (see ReadNextByte() in the firmware)
+    if (address == kConfigAddress + 4 || address == kConfigAddress + 7)
+        return 0xFF;
+    const uint8_t* p = const_cast<SimDevice*>(this)->locate(address);
+    return p != nullptr ? *p : 0x00;
+}
+
+void SimDevice::poke(uint32_t address, uint8_t value) {
+    if (uint8_t* p = locate(address))
+        *p = value;
+}
+
+void SimDevice::program(uint32_t address, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        uint32_t a = address + static_cast<uint32_t>(i);
+        if (a < kProgramStart)
+            continue;  // Boot block is write protected
+        if (uint8_t* p = locate(a))
+            *p &= data[i];  // Programming can only turn 1s into 0s
+    }
+}
+
+void SimDevice::erase_device() {
+    std::fill(flash_.begin() + kProgramStart, flash_.end(), 0xFF);
+    std::fill(eeprom_.begin(), eeprom_.end(), 0xFF);
+    std::fill(user_id_.begin(), user_id_.end(), 0xFF);
+}
+
+void SimDevice::write(const Packet& in) {
+    ++stats_.reports_written;
+    Packet out;
+    switch (in.command()) {
+    case Command::QueryDevice: {
+        out = make_command(Command::QueryDevice);
+        out.set_u8(1, kDataBlockSize);
+        out.set_u8(2, 1);
+        const MemoryRegion regions[] = {
+            {MemoryType::Program, kProgramStart, kProgramEnd - kProgramStart},
+            {MemoryType::Config, kConfigAddress, kConfigSize},
+            {MemoryType::Program, kUserIdAddress, kUserIdSize},
+            {MemoryType::Eeprom, kEepromAddress, kEepromSize},
+        };
+        size_t at = 3;
+        for (const MemoryRegion& r : regions) {
+            out.set_u8(at, static_cast<uint8_t>(r.type));
+            out.set_u32(at + 1, r.address);
+            out.set_u32(at + 5, r.length);
+            at += 9;
+        }
+        out.set_u8(at, static_cast<uint8_t>(MemoryType::EndOfList));
+        respond(out);
+        break;
+    }
+    case Command::UnlockConfig:
+        configs_locked_ = in.u8(offset::kLockValue) != kUnlockConfig;
+        break;
+    case Command::EraseDevice:
+        erase_device();
+        break;
+    case Command::ProgramDevice: {
+        const uint32_t address = in.address();
+        if (is_config_address(address)) {
+            if (!configs_locked_) {
+                for (size_t i = 0; i < in.size(); ++i) {
+                    if (uint8_t* p = locate(address + static_cast<uint32_t>(i)))
+                        *p = in.payload()[i];
+                }
+            }
+            break;
+        }
+        if (is_eeprom_address(address)) {
+            for (size_t i = 0; i < in.size(); ++i) {
+                if (uint8_t* p = locate(address + static_cast<uint32_t>(i)))
+                    *p = in.payload()[i];  // EEPROM writes erase the byte first
+            }
+            break;
+        }
+        if (programmed_pointer_ == kInvalidAddress)
+            programmed_pointer_ = address;
+        if (programmed_pointer_ == address) {
+            program(address, in.payload(), in.size());
+            programmed_pointer_ += in.size();
+        }
+        break;
+    }
+    case Command::ProgramComplete:
+        programmed_pointer_ = kInvalidAddress;
+        break;
+    case Command::GetData: {
+        out = make_command(Command::GetData);
+        out.set_u32(offset::kAddress, in.address());
+        const uint8_t size = std::min<uint8_t>(in.size(), kDataBlockSize);
+        out.set_u8(offset::kSize, size);
+        for (uint8_t i = 0; i < size; ++i)
+            out.bytes[offset::kData + kDataBlockSize - size + i] = peek(in.address() + i);
+        respond(out);
+        break;
+    }
+    case Command::ResetDevice:
+        ++reset_count_;
+        configs_locked_ = true;
+        programmed_pointer_ = kInvalidAddress;
+        responses_.clear();
+        break;
+    default:
+        break;  // Not in a stock build: the firmware's switch just ignores it
+    }
+}
+
+bool SimDevice::read(Packet& packet, std::chrono::milliseconds) {
+    if (responses_.empty())
+        return false;
+    packet = responses_.front();
+    responses_.pop_front();
+    ++stats_.reports_read;
+    return true;
+}
+
+}  // namespace sk28a
@@ -0,0 +1,187 @@
+// flash_boards() against a row of SimDevices, flashed in parallel
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "check.h"
+#include "samples.h"
+#include "sk28a/board_pool.h"
+#include "sk28a/sim_device.h"
+
+using namespace sk28a;
+using sk28a_test::first_difference;
+using sk28a_test::kAllMatch;
+using sk28a_test::sample_image;
+
+namespace {
+
+// Keeps count of the boards open at once.  A board holds its first report
+// until `together` of them have been open at the same time (or every board
+// has been opened), so the pool can't get away with flashing them one after
+// the other.
+class Fixture {
+public:
+    Fixture(size_t boards, size_t together) : devices_(boards), together_(together) {}
+
+    SimDevice& device(size_t index) { return devices_[index]; }
+    size_t most_open() const { return most_open_; }
+
+    void opened() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++open_;
+        ++ever_opened_;
+        most_open_ = std::max(most_open_, open_);
+        changed_.notify_all();
+    }
+    void closed() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --open_;
+    }
+    // False if the others never turned up
+    bool wait_for_the_others() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return changed_.wait_for(lock, std::chrono::seconds(5),
+                                 [&] { return most_open_ >= together_ || ever_opened_ == devices_.size(); });
+    }
+
+private:
+    std::vector<SimDevice> devices_;
+    size_t together_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    size_t open_ = 0;
+    size_t ever_opened_ = 0;
+    size_t most_open_ = 0;
+};
+
+// One board of the fixture, open for as long as the pool holds on to it
+class Board : public Transport {
+public:
+    Board(Fixture& fixture, size_t index) : fixture_(fixture), device_(fixture.device(index)) { fixture_.opened(); }
+    ~Board() override { fixture_.closed(); }
+
+    void write(const Packet& packet) override {
+        if (!waited_) {
+            waited_ = true;
+            if (!fixture_.wait_for_the_others())
+                throw TransportError("the other boards never opened");
+        }
+        ++stats_.reports_written;
+        device_.write(packet);
+    }
+    bool read(Packet& packet, std::chrono::milliseconds timeout) override {
+        const bool got = device_.read(packet, timeout);
+        if (got)
+            ++stats_.reports_read;
+        return got;
+    }
+    std::string description() const override { return "board on " + device_.description(); }
+
+private:
+    Fixture& fixture_;
+    SimDevice& device_;
+    bool waited_ = false;
+};
+
+std::vector<BoardTarget> targets(Fixture& fixture, size_t count) {
+    std::vector<BoardTarget> boards(count);
+    for (size_t i = 0; i < count; ++i) {
+        boards[i].name = "board " + std::to_string(i);
+        boards[i].location = "port " + std::to_string(i + 1);
+        boards[i].open = [&fixture, i] { return std::make_unique<Board>(fixture, i); };
+    }
+    return boards;
+}
+
+// What of the image a board ends up with: not the bootloader block, nor the config words
+ImageView writable_part(const ImageView& image) {
+    SimDevice device;
+    Flasher flasher(device, FlashOptions());
+    flasher.query();
+    return flasher.writable_part(image);
+}
+
+}  // namespace
+
+TEST(pool_flashes_every_board) {
+    Fixture fixture(4, 4);
+    std::vector<BoardTarget> boards = targets(fixture, 4);
+    for (size_t i = 0; i < boards.size(); ++i)
+        boards[i].user_id = UserId{'S', 'K', '0', '0', '0', '0', '0', static_cast<uint8_t>('1' + i)};
+    const Image image = sample_image();
+
+    std::mutex mutex;
+    std::vector<unsigned> done_calls(boards.size());
+    std::vector<bool> progressed(boards.size());
+    const std::vector<BoardResult> results = flash_boards(
+        boards, image, FlashOptions(), 0,
+        [&](size_t index, std::string_view, uint64_t, uint64_t) {
+            std::lock_guard<std::mutex> lock(mutex);
+            progressed.at(index) = true;
+        },
+        [&](size_t index, const BoardResult&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++done_calls.at(index);
+        });
+
+    CHECK_EQ(fixture.most_open(), 4u);  // 0 jobs: all of them at once
+    CHECK_EQ(results.size(), boards.size());
+    const uint64_t bytes = writable_part(image).byte_count();
+    for (size_t i = 0; i < boards.size(); ++i) {
+        const BoardResult& r = results[i];
+        CHECK_EQ(r.name, boards[i].name);
+        CHECK_EQ(r.location, boards[i].location);
+        CHECK(r.ok);
+        CHECK_EQ(r.error, "");
+        CHECK_EQ(r.bytes, bytes + kUserIdSize);
+        CHECK_EQ(r.resumed, 0u);
+        CHECK(r.stats.reports_written > 0);
+        CHECK(r.stats.reports_read > 0);
+        CHECK_EQ(done_calls[i], 1u);
+        CHECK(progressed[i]);
+
+        // Each board has the image, stamped with its own serial number
+        const SimDevice& device = fixture.device(i);
+        const ImageView stamped = ImageView(image).with(kUserIdAddress, boards[i].user_id->data(), kUserIdSize);
+        CHECK_EQ(first_difference(device, writable_part(stamped)), kAllMatch);
+        CHECK_EQ(device.peek(kUserIdAddress + 7), '1' + i);
+        CHECK_EQ(device.reset_count(), 1u);
+    }
+}
+
+TEST(pool_keeps_to_its_jobs) {
+    Fixture fixture(5, 2);
+    const std::vector<BoardTarget> boards = targets(fixture, 5);
+    const Image image = sample_image();
+    const std::vector<BoardResult> results = flash_boards(boards, image, FlashOptions(), 2);
+
+    CHECK_EQ(fixture.most_open(), 2u);
+    for (size_t i = 0; i < boards.size(); ++i) {
+        CHECK(results[i].ok);
+        CHECK_EQ(results[i].error, "");
+        CHECK_EQ(first_difference(fixture.device(i), writable_part(image)), kAllMatch);
+    }
+}
+
+TEST(pool_reports_a_failing_board_and_flashes_the_rest) {
+    Fixture fixture(3, 2);
+    std::vector<BoardTarget> boards = targets(fixture, 3);
+    boards[1].open = []() -> std::unique_ptr<Transport> { throw TransportError("board 1 is gone"); };
+    const Image image = sample_image();
+    const std::vector<BoardResult> results = flash_boards(boards, image, FlashOptions(), 0);
+
+    CHECK(!results[1].ok);
+    CHECK_EQ(results[1].error, "board 1 is gone");
+    CHECK_EQ(results[1].bytes, 0u);
+    CHECK_EQ(results[1].stats.reports_written, 0u);
+    CHECK_EQ(fixture.device(1).peek(0x1000), 0xFF);
+    for (size_t i : {0u, 2u}) {
+        CHECK(results[i].ok);
+        CHECK_EQ(results[i].error, "");
+        CHECK_EQ(results[i].bytes, writable_part(image).byte_count());
+        CHECK_EQ(first_difference(fixture.device(i), writable_part(image)), kAllMatch);
+    }
+}
@@ -0,0 +1,62 @@
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+namespace sk28a_test {
+
+namespace {
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<Test>& tests() {
+    static std::vector<Test> all;
+    return all;
+}
+
+int failures = 0;
+
+}  // namespace
+
+bool add(const char* name, void (*test)()) {
+    tests().push_back({name, test});
+    return true;
+}
+
+void fail(const std::string& what, const char* file, int line) {
+    std::fprintf(stderr, "%s:%d: %s\n", file, line, what.c_str());
+    ++failures;
+}
+
+}  // namespace sk28a_test
+
+int main(int argc, char** argv) {
+    using namespace sk28a_test;
+    int failed = 0;
+    int ran = 0;
+    for (const Test& t : tests()) {
+        bool wanted = argc == 1;
+        for (int i = 1; i < argc; ++i)
+            wanted |= std::strcmp(argv[i], t.name) == 0;
+        if (!wanted)
+            continue;
+        ++ran;
+        const int before = failures;
+        try {
+            t.run();
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s threw: %s\n", t.name, e.what());
+            ++failures;
+        }
+        const bool ok = failures == before;
+        failed += !ok;
+        std::printf("%-6s %s\n", ok ? "ok" : "FAILED", t.name);
+    }
+    std::printf("%d of %d tests passed\n", ran - failed, ran);
+    return failed == 0 && ran > 0 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+// Minimal test harness, so the tests need nothing beyond the compiler.
+//
+//   TEST(name) { ... }          registers a test
+//   CHECK(condition)            records a failure and carries on
+//   CHECK_EQ(actual, expected)  the same, showing both values
+//   CHECK_THROWS(expression, ExceptionType)
+//
+// check.cpp has main(): it runs every test, or those named on the command
+// line, and exits non-zero if any of them failed or threw.
+#ifndef SK28A_TESTS_CHECK_H
+#define SK28A_TESTS_CHECK_H
+
+#include <string>
+#include <type_traits>
+
+namespace sk28a_test {
+
+bool add(const char* name, void (*test)());
+void fail(const std::string& what, const char* file, int line);
+
+template <typename T>
+std::string show(const T& value) {
+    if constexpr (std::is_enum_v<T>)
+        return std::to_string(static_cast<long long>(value));
+    else if constexpr (std::is_integral_v<T>)
+        return std::to_string(+value);
+    else if constexpr (std::is_convertible_v<T, std::string>)
+        return "\"" + std::string(value) + "\"";
+    else
+        return "?";
+}
+
+template <typename A, typename B>
+void check_eq(const A& actual, const B& expected, const char* text, const char* file, int line) {
+    if (!(actual == expected))
+        fail(std::string(text) + ": got " + show(actual) + ", expected " + show(expected), file, line);
+}
+
+}  // namespace sk28a_test
+
+#define TEST(name)                                                               \
+    static void name();                                                          \
+    static const bool name##_registered = sk28a_test::add(#name, name);          \
+    static void name()
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition))                                                        \
+            sk28a_test::fail("CHECK(" #condition ")", __FILE__, __LINE__);      \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    sk28a_test::check_eq((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression, type)                                                         \
+    do {                                                                                       \
+        bool thrown_ = false;                                                                  \
+        try {                                                                                  \
+            expression;                                                                        \
+        } catch (const type&) {                                                                \
+            thrown_ = true;                                                                    \
+        }                                                                                      \
+        if (!thrown_)                                                                          \
+            sk28a_test::fail(#expression " didn't throw " #type, __FILE__, __LINE__);         \
+    } while (0)
+
+#endif  // SK28A_TESTS_CHECK_H
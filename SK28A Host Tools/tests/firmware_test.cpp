@@ -0,0 +1,386 @@
+// Flasher against the bootloader firmware itself (FirmwareDevice).  Built once
+// per firmware variant in CMakeLists.txt; the tests go by the ExtendedFeatures
+// the build reports, so each covers what its variant can do.
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "samples.h"
+#include "sk28a/firmware_device.h"
+#include "sk28a/flasher.h"
+#include "sk28a/libusb_transport.h"
+
+using namespace sk28a;
+using sk28a_test::first_difference;
+using sk28a_test::kAllMatch;
+using sk28a_test::sample_image;
+
+namespace {
+
+FlashOptions with(EraseMode erase, VerifyMode verify) {
+    FlashOptions options;
+    options.erase = erase;
+    options.verify = verify;
+    options.reset = false;
+    return options;
+}
+
+uint16_t features() {
+    FirmwareDevice device;
+    Flasher flasher(device);
+    return flasher.query().extended_features;
+}
+
+std::vector<EraseMode> erase_modes(uint16_t features) {
+    std::vector<EraseMode> modes = {EraseMode::Full};
+    if (features & feature::kEraseRange)
+        modes.push_back(EraseMode::Range);
+    if (features & feature::kLazyErase)
+        modes.push_back(EraseMode::Lazy);
+    return modes;
+}
+
+std::vector<VerifyMode> verify_modes(uint16_t features) {
+    std::vector<VerifyMode> modes = {VerifyMode::Read};
+    if (features & feature::kVerifyRange)
+        modes.push_back(VerifyMode::Crc);
+    return modes;
+}
+
+// Passes reports on, noting the ranges VERIFY_RANGE was asked for
+class VerifyRangeRecorder : public Transport {
+public:
+    explicit VerifyRangeRecorder(Transport& to) : to_(to) {}
+
+    void write(const Packet& packet) override {
+        if (packet.command() == Command::VerifyRange)
+            ranges.emplace_back(packet.address(), packet.u32(offset::kLength));
+        to_.write(packet);
+    }
+    bool read(Packet& packet, std::chrono::milliseconds timeout) override { return to_.read(packet, timeout); }
+    std::string description() const override { return to_.description(); }
+
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+
+private:
+    Transport& to_;
+};
+
+bool asked(const VerifyRangeRecorder& recorder, uint32_t address, uint32_t length) {
+    for (const auto& range : recorder.ranges) {
+        if (range == std::make_pair(address, length))
+            return true;
+    }
+    return false;
+}
+
+// What the board holds once `patch` has gone over `base`
+Image merged(const Image& base, const Image& patch) {
+    Image out = base;
+    for (const auto& [address, bytes] : patch.segments())
+        out.write(address, bytes.data(), bytes.size());
+    return out;
+}
+
+// Address and transfer type of each endpoint in a configuration descriptor
+std::vector<std::pair<uint8_t, uint8_t>> endpoints_of(const std::vector<uint8_t>& config) {
+    std::vector<std::pair<uint8_t, uint8_t>> endpoints;
+    for (size_t i = 0; i + 3 < config.size() && config[i] != 0; i += config[i]) {
+        if (config[i + 1] == 5)
+            endpoints.emplace_back(config[i + 2], config[i + 3] & 0x03);
+    }
+    return endpoints;
+}
+
+}  // namespace
+
+TEST(firmware_erase_and_verify_modes) {
+    const uint16_t available = features();
+    for (EraseMode erase : erase_modes(available)) {
+        for (VerifyMode verify : verify_modes(available)) {
+            FirmwareDevice device;
+            for (uint32_t a = 0x1000; a < 0x8000; a += 0x100)
+                device.poke(a, 0x00);  // Left over from the last application
+            device.poke(0x1830, 0x00);    // In a row the image uses, but not in the image
+            device.poke(0xF00010, 0x00);
+            Flasher flasher(device, with(erase, verify));
+            const Image image = sample_image();
+            flasher.flash(image);
+            CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+            CHECK_EQ(device.peek(0x1830), 0xFF);  // Erased, whichever way
+            if (erase != EraseMode::Lazy)
+                CHECK_EQ(device.peek(0xF00010), 0xFF);
+            if (erase == EraseMode::Full)
+                CHECK_EQ(device.peek(0x7F00), 0xFF);
+        }
+    }
+}
+
+TEST(firmware_interface_is_what_the_transports_expect) {
+    FirmwareDevice device;
+    const std::vector<uint8_t> config = device.descriptor(2);
+    CHECK(config.size() > 18);
+    const std::vector<std::pair<uint8_t, uint8_t>> endpoints = endpoints_of(config);
+    const uint8_t interface_class = config[9 + 5];
+    if (interface_class == kVendorInterfaceClass) {
+        // The USB_USE_GEN build, which sk28a-flash hands to LibusbTransport
+        auto bulk = [&](uint8_t address) {
+            const std::pair<uint8_t, uint8_t> wanted(address, 2);
+            return std::find(endpoints.begin(), endpoints.end(), wanted) != endpoints.end();
+        };
+        CHECK_EQ(endpoints.size(), 2u);
+        CHECK(bulk(kBulkOutEndpoint));
+        CHECK(bulk(kBulkInEndpoint));
+    } else {
+        CHECK_EQ(interface_class, 0x03);  // HID, for hidraw
+    }
+}
+
+TEST(firmware_clear_halt_starts_the_data_endpoints_over) {
+    FirmwareDevice device;
+    const std::vector<std::pair<uint8_t, uint8_t>> endpoints = endpoints_of(device.descriptor(2));
+    CHECK_EQ(endpoints.size(), 2u);
+    Flasher flasher(device, FlashOptions());
+    flasher.query();  // One packet each way, so with USB_USE_PING_PONG the odd BDs are next in line
+    for (const auto& endpoint : endpoints)
+        device.clear_halt(endpoint.first);
+    const Image image = sample_image();
+    flasher.flash(image);
+    CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+}
+
+TEST(firmware_serial_number_is_the_user_id) {
+    FirmwareDevice device;
+    const UserId id{0x53, 0x4B, 0x28, 0xA0, 0x00, 0x01, 0xC3, 0x5E};
+    Flasher flasher(device, FlashOptions());
+    flasher.flash(ImageView(sample_image()).with(kUserIdAddress, id.data(), id.size()));
+    CHECK_EQ(device.reset_count(), 1ul);  // The string is built at startup, from the new User ID
+
+    const std::vector<uint8_t> dev = device.descriptor(1);
+    CHECK_EQ(dev.size(), 18u);
+    const uint8_t index = dev[16];  // iSerialNumber
+#if defined(SK28A_FIRMWARE_USE_SERIAL_NUMBER_STRING)
+    CHECK(index != 0);
+    const std::vector<uint8_t> string = device.descriptor(3, index, 0x0409);
+    CHECK_EQ(string.size(), 2 + 4 * kUserIdSize);
+    CHECK_EQ(string[0], string.size());
+    CHECK_EQ(string[1], 3);
+    std::string text;  // UTF-16LE, all ASCII
+    for (size_t i = 2; i + 1 < string.size(); i += 2) {
+        CHECK_EQ(string[i + 1], 0);
+        text += static_cast<char>(string[i]);
+    }
+    CHECK_EQ(text, serial_number(id));
+#else
+    CHECK_EQ(index, 0);
+#endif
+}
+
+TEST(firmware_reset_after_flash) {
+    FirmwareDevice device;
+    FlashOptions options;
+    Flasher flasher(device, options);
+    flasher.flash(sample_image());
+    CHECK_EQ(device.reset_count(), 1ul);
+}
+
+TEST(firmware_erase_none_after_full) {
+    FirmwareDevice device;
+    const Image image = sample_image();
+    Flasher(device, with(EraseMode::Full, VerifyMode::None)).flash(image);
+    // The same image again over it: programming clears no further bits
+    Flasher flasher(device, with(EraseMode::None, VerifyMode::Read));
+    flasher.flash(image);
+    CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+}
+
+TEST(firmware_mismatch_is_reported) {
+    const uint16_t available = features();
+    for (VerifyMode verify : verify_modes(available)) {
+        FirmwareDevice device;
+        const Image image = sample_image();
+        Flasher(device, with(EraseMode::Full, VerifyMode::None)).flash(image);
+        const uint8_t expected = image.segments().at(0x1838)[0x40];
+        device.poke(0x1878, static_cast<uint8_t>(expected ^ 0x01));
+
+        Flasher flasher(device, with(EraseMode::None, verify));
+        flasher.query();
+        try {
+            flasher.verify(image);
+            sk28a_test::fail("verify() didn't throw", __FILE__, __LINE__);
+        } catch (const VerifyError& e) {
+            CHECK_EQ(e.address, 0x1878u);
+            CHECK_EQ(e.expected, expected);
+            CHECK_EQ(e.actual, expected ^ 0x01);
+        }
+    }
+}
+
+TEST(firmware_missing_extensions_are_refused) {
+    const uint16_t available = features();
+    std::vector<FlashOptions> refused;
+    if (!(available & feature::kEraseRange))
+        refused.push_back(with(EraseMode::Range, VerifyMode::Read));
+    if (!(available & feature::kLazyErase))
+        refused.push_back(with(EraseMode::Lazy, VerifyMode::Read));
+    if (!(available & feature::kPatch))
+        refused.push_back(with(EraseMode::Patch, VerifyMode::Read));
+    if (!(available & feature::kVerifyRange))
+        refused.push_back(with(EraseMode::Full, VerifyMode::Crc));
+    for (const FlashOptions& options : refused) {
+        FirmwareDevice device;
+        Flasher flasher(device, options);
+        CHECK_THROWS(flasher.flash(sample_image()), ProtocolError);
+    }
+}
+
+TEST(firmware_compressed_and_fill_packets) {
+    const uint16_t available = features();
+    FirmwareDevice device;
+    Flasher flasher(device, with(EraseMode::Full, VerifyMode::Read));
+    const Image image = sample_image();
+    flasher.flash(image);
+    CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+    const ProgramStats& stats = flasher.program_stats();
+    // 0x2000-0x2FFF is one long run of zeros
+    CHECK_EQ(stats.fill_packets > 0, (available & feature::kFill) != 0);
+    CHECK_EQ(stats.compressed_packets > 0, (available & feature::kCompressedProgramming) != 0);
+    if (available & (feature::kFill | feature::kCompressedProgramming))
+        CHECK(stats.payload < stats.bytes);
+    else
+        CHECK_EQ(stats.payload, stats.bytes);
+}
+
+TEST(firmware_patch_keeps_the_rest_of_the_rows) {
+    const uint16_t available = features();
+    if (!(available & feature::kPatch))
+        return;
+    FirmwareDevice device;
+    const Image base = sample_image();
+    Flasher(device, with(EraseMode::Full, VerifyMode::Read)).flash(base);
+    // Spans two rows, neither of which it fills
+    const Image patch = sk28a_test::noise(0x1030, 0x20, 99);
+    Flasher flasher(device, with(EraseMode::Patch, verify_modes(available).back()));
+    flasher.flash(patch);
+    const Image after = merged(base, patch);
+    CHECK_EQ(first_difference(device, flasher.writable_part(after)), kAllMatch);
+}
+
+TEST(firmware_lazy_erase_after_patch) {
+    const uint16_t available = features();
+    if (!(available & feature::kLazyErase) || !(available & feature::kPatch))
+        return;
+    FirmwareDevice device;
+    Flasher(device, with(EraseMode::Full, VerifyMode::None)).flash(sample_image());
+    Flasher(device, with(EraseMode::Patch, VerifyMode::Read)).flash(sk28a_test::noise(0x1050, 4, 7));
+    // Lazy erase has to erase the patched row again before writing it
+    const Image image = sk28a_test::noise(0x1040, 0x40, 8);
+    Flasher flasher(device, with(EraseMode::Lazy, VerifyMode::Read));
+    flasher.flash(image);
+    CHECK_EQ(first_difference(device, image), kAllMatch);
+}
+
+TEST(firmware_fill_out_of_range_is_dropped) {
+    if (!(features() & feature::kFill))
+        return;
+    FirmwareDevice device;
+    Flasher flasher(device, with(EraseMode::Full, VerifyMode::None));
+    flasher.query();
+    flasher.erase(Image());
+    auto fill = [&](uint32_t address, uint32_t length) {
+        Packet p = make_range(Command::Fill, address, length);
+        p.set_u8(offset::kFillValue, 0x00);
+        device.write(p);
+        device.write(make_command(Command::ProgramComplete));
+        flasher.query();  // Its response comes after the FILL has been done with
+    };
+    fill(0x0F00, 0x200);       // Starts in the bootloader
+    fill(0x7FF0, 0x20);        // Runs past the end
+    fill(0x1000, 0xFFFFFFF0);  // Wraps around
+    CHECK_EQ(device.peek(0x0F00), 0xFF);
+    CHECK_EQ(device.peek(0x1000), 0xFF);
+    CHECK_EQ(device.peek(0x7FF0), 0xFF);
+    fill(0x1000, 0x7000);
+    CHECK_EQ(device.peek(0x1000), 0x00);
+    CHECK_EQ(device.peek(0x7FFF), 0x00);
+}
+
+TEST(firmware_compressed_out_of_range_is_dropped) {
+    if (!(features() & feature::kCompressedProgramming))
+        return;
+    FirmwareDevice device;
+    Flasher flasher(device, with(EraseMode::Full, VerifyMode::None));
+    const size_t chunk = flasher.query().packet_data_field_size;
+    flasher.erase(Image());
+    // As many zeros as one packet can carry: some 3.7 KB
+    const std::vector<uint8_t> zeros(0x1000, 0x00);
+    std::vector<uint8_t> encoded;
+    const size_t taken = packbits_encode(zeros.data(), zeros.size(), chunk, encoded);
+    CHECK(taken > 0xC00);
+    // Returns how long the flash writes took
+    auto send = [&](uint32_t address) {
+        const auto before = device.write_time();
+        device.write(make_data_packet(Command::ProgramCompressed, address, encoded.data(), encoded.size()));
+        device.write(make_command(Command::ProgramComplete));
+        flasher.query();  // Its response comes after the packet has been done with
+        return device.write_time() - before;
+    };
+    std::vector<uint8_t> config;
+    for (uint32_t a = 0x300000; a < 0x30000E; ++a)
+        config.push_back(device.peek(a));
+
+    send(0x0800);  // The bootloader
+    send(0x300000);  // The config words
+    for (uint32_t a = 0x0800; a < 0x1000 + taken; a += 0x40)
+        CHECK_EQ(device.peek(a), 0xFF);
+    for (uint32_t a = 0x300000; a < 0x30000E; ++a)
+        CHECK_EQ(device.peek(a), config[a - 0x300000]);
+
+    // Starts inside program memory, but the runs go on past its end: only the 16 bytes up to 0x8000 get written,
+    // which takes as long as 16 bytes do elsewhere
+    const auto at_end = send(0x7FF0);
+    CHECK_EQ(device.peek(0x7FF0), 0x00);
+    CHECK_EQ(device.peek(0x7FFF), 0x00);
+    encoded.clear();
+    packbits_encode(zeros.data(), 16, chunk, encoded);
+    CHECK_EQ(at_end.count(), send(0x1000).count());
+    CHECK_EQ(device.peek(0x1000), 0x00);
+    CHECK_EQ(device.peek(0x1010), 0xFF);
+}
+
+TEST(firmware_crc_verify_uses_stored_row_crcs) {
+    if (!(features() & feature::kVerifyRange))
+        return;
+    const Image image = sample_image();
+    sk28a_test::TempFile file("stored.sk28img");
+    write_image_file(image, file.path());
+    const ImageFile mapped(file.path());
+    for (EraseMode erase : {EraseMode::Full, EraseMode::None}) {
+        FirmwareDevice device;
+        if (erase == EraseMode::None)
+            Flasher(device, with(EraseMode::Full, VerifyMode::None)).flash(image);
+        VerifyRangeRecorder recorder(device);
+        Flasher flasher(recorder, with(erase, VerifyMode::Crc));
+        flasher.flash(mapped);
+        CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+        // 0x2000-0x3043 ends inside a row: the stored CRCs cover it to the row's end, on flash just erased.
+        // 0x1810-0x182F shares its row with the next section, so gets a CRC of its own either way.
+        CHECK_EQ(asked(recorder, 0x2000, 0x1080), erase == EraseMode::Full);
+        CHECK_EQ(asked(recorder, 0x2000, 0x1044), erase == EraseMode::None);
+        CHECK(asked(recorder, 0x1810, 0x20));
+    }
+
+    // A bad byte is still found, and pinpointed
+    FirmwareDevice device;
+    Flasher(device, with(EraseMode::Full, VerifyMode::None)).flash(mapped);
+    device.poke(0x2345, 0x01);
+    Flasher flasher(device, with(EraseMode::Full, VerifyMode::Crc));
+    flasher.query();
+    try {
+        flasher.verify(mapped);
+        sk28a_test::fail("verify() didn't throw", __FILE__, __LINE__);
+    } catch (const VerifyError& e) {
+        CHECK_EQ(e.address, 0x2345u);
+    }
+}
@@ -0,0 +1,120 @@
+// Flasher against SimDevice, the stock bootloader's protocol without the firmware
+#include "check.h"
+#include "samples.h"
+#include "sk28a/flasher.h"
+#include "sk28a/sim_device.h"
+
+using namespace sk28a;
+using sk28a_test::first_difference;
+using sk28a_test::kAllMatch;
+using sk28a_test::sample_image;
+
+namespace {
+
+FlashOptions with(EraseMode erase, VerifyMode verify) {
+    FlashOptions options;
+    options.erase = erase;
+    options.verify = verify;
+    return options;
+}
+
+}  // namespace
+
+TEST(sim_full_erase_read_verify) {
+    SimDevice device;
+    device.poke(0x6000, 0x00);  // Left over from the last application
+    device.poke(0xF000F0, 0x00);
+    Flasher flasher(device, with(EraseMode::Full, VerifyMode::Read));
+    const Image image = sample_image();
+    flasher.flash(image);
+    CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+    CHECK_EQ(device.peek(0x6000), 0xFF);
+    CHECK_EQ(device.peek(0xF000F0), 0xFF);
+    CHECK_EQ(device.peek(0x0800), 0xFF);  // The bootloader block is never written
+    CHECK_EQ(device.peek(0x300000), 0xFF);  // Nor the config words, unless asked
+    CHECK_EQ(device.reset_count(), 1u);
+    // The blank blocks inside the first section are left out after the erase
+    CHECK_EQ(flasher.program_stats().bytes, flasher.writable_part(image).byte_count() - 0x100);
+}
+
+TEST(sim_erase_none_programs_over_erased_flash) {
+    SimDevice device;
+    Flasher flasher(device, with(EraseMode::None, VerifyMode::Read));
+    const Image image = sample_image();
+    flasher.flash(image);
+    CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+}
+
+TEST(sim_erase_none_over_old_data_fails_verify) {
+    SimDevice device;
+    device.poke(0x1100, 0x00);  // Programming can't set the bits back
+    Flasher flasher(device, with(EraseMode::None, VerifyMode::Read));
+    CHECK_THROWS(flasher.flash(sample_image()), VerifyError);
+}
+
+TEST(sim_config_words_when_asked) {
+    SimDevice device;
+    FlashOptions options;
+    options.program_config = true;
+    Flasher flasher(device, options);
+    const Image image = sample_image();
+    flasher.flash(image);
+    CHECK_EQ(device.peek(0x300000), image.segments().at(0x300000)[0]);
+    CHECK_EQ(device.peek(0x30000D), image.segments().at(0x300000)[13]);
+}
+
+TEST(sim_extensions_a_stock_build_lacks) {
+    // SimDevice reports no ExtendedFeatures, like a stock build
+    for (const FlashOptions& options : {with(EraseMode::Range, VerifyMode::Read), with(EraseMode::Lazy, VerifyMode::Read),
+                                        with(EraseMode::Patch, VerifyMode::Read), with(EraseMode::Full, VerifyMode::Crc)}) {
+        SimDevice device;
+        Flasher flasher(device, options);
+        CHECK_THROWS(flasher.flash(sample_image()), ProtocolError);
+    }
+}
+
+TEST(sim_mismatch_is_reported) {
+    SimDevice device;
+    FlashOptions options;
+    options.verify = VerifyMode::None;
+    options.reset = false;
+    Flasher flasher(device, options);
+    const Image image = sample_image();
+    flasher.flash(image);
+    const uint8_t expected = image.segments().at(0x1000)[0x123];
+    device.poke(0x1123, static_cast<uint8_t>(expected ^ 0x5A));
+
+    Flasher verifier(device, with(EraseMode::None, VerifyMode::Read));
+    verifier.query();
+    try {
+        verifier.verify(image);
+        sk28a_test::fail("verify() didn't throw", __FILE__, __LINE__);
+    } catch (const VerifyError& e) {
+        CHECK_EQ(e.address, 0x1123u);
+        CHECK_EQ(e.expected, expected);
+        CHECK_EQ(e.actual, expected ^ 0x5A);
+    }
+}
+
+TEST(sim_writable_part) {
+    SimDevice device;
+    Flasher flasher(device);
+    flasher.query();
+    const Image image = sample_image();
+    const ImageView part = flasher.writable_part(image);
+    CHECK_EQ(part.runs().front().address, 0x1000u);
+    CHECK(part.slice(0x300000, 0x310000).empty());
+    CHECK_EQ(part.byte_count(), image.byte_count() - 0x20 - 14);
+
+    FlashOptions options;
+    options.program_config = true;
+    Flasher with_config(device, options);
+    with_config.query();
+    CHECK(with_config.writable_part(image).slice(0x300000, 0x310000).byte_count() == 14);
+
+    Image elsewhere;
+    const uint8_t b = 0;
+    elsewhere.write(0x0400, &b, 1);
+    elsewhere.write(0x9000, &b, 1);
+    CHECK_THROWS(flasher.flash(elsewhere), ProtocolError);
+}
@@ -0,0 +1,186 @@
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "samples.h"
+#include "sk28a/image.h"
+#include "sk28a/journal.h"
+#include "sk28a/protocol.h"
+
+using namespace sk28a;
+using sk28a_test::sample_image;
+using sk28a_test::TempFile;
+using sk28a_test::to_hex;
+
+namespace {
+
+bool same(const Image& a, const Image& b) { return a.segments() == b.segments(); }
+
+// The same runs holding the same bytes
+bool same(const ImageView& a, const Image& b) {
+    if (a.runs().size() != b.segments().size())
+        return false;
+    auto segment = b.segments().begin();
+    for (const ImageView::Run& run : a.runs()) {
+        if (run.address != segment->first ||
+            std::vector<uint8_t>(run.data, run.data + run.size) != segment->second)
+            return false;
+        ++segment;
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(hex_records_and_extended_addresses) {
+    const Image image = parse_hex(
+        ":0400000001020304F2\r\n"
+        ":020000040030CA\r\n"
+        ":02000000AABB99\r\n"
+        ":020000021000EC\r\n"
+        ":01000400CC2F\r\n"
+        ":00000001FF\r\n");
+    CHECK_EQ(image.byte_count(), 7u);
+    const Image::Segments& s = image.segments();
+    CHECK(s.count(0x0000) == 1 && s.at(0x0000) == std::vector<uint8_t>({1, 2, 3, 4}));
+    CHECK(s.count(0x300000) == 1 && s.at(0x300000) == std::vector<uint8_t>({0xAA, 0xBB}));
+    // A segment address record replaces the linear one: 0x1000 << 4
+    CHECK(s.count(0x10004) == 1 && s.at(0x10004) == std::vector<uint8_t>({0xCC}));
+}
+
+TEST(hex_round_trip) {
+    const Image image = sample_image();
+    CHECK(same(parse_hex(to_hex(image)), image));
+}
+
+TEST(malformed_hex_throws) {
+    const std::string good = to_hex(sample_image());
+    CHECK_THROWS(parse_hex(""), HexError);
+    // Checksum: the last digit of the first record
+    std::string bad = good;
+    const size_t eol = bad.find('\n');
+    bad[eol - 1] = bad[eol - 1] == '0' ? '1' : '0';
+    CHECK_THROWS(parse_hex(bad), HexError);
+    // A digit that isn't one
+    bad = good;
+    bad[9] = 'G';
+    CHECK_THROWS(parse_hex(bad), HexError);
+    // Truncated: a record cut short, and a file without its end record
+    CHECK_THROWS(parse_hex(good.substr(0, eol - 2) + "\n" + good.substr(eol + 1)), HexError);
+    CHECK_THROWS(parse_hex(good.substr(0, good.rfind(':'))), HexError);
+    CHECK_THROWS(parse_hex("0400000001020304F2\n:00000001FF\n"), HexError);
+    CHECK_THROWS(parse_hex(":00000007F9\n:00000001FF\n"), HexError);  // Unknown record type
+}
+
+TEST(later_writes_win) {
+    Image image;
+    const uint8_t a[] = {1, 1, 1, 1};
+    const uint8_t b[] = {2, 2};
+    image.write(0x10, a, 4);
+    image.write(0x12, b, 2);
+    image.write(0x14, b, 2);  // Adjoining: joins the segment
+    CHECK_EQ(image.segments().size(), 1u);
+    CHECK(image.segments().at(0x10) == std::vector<uint8_t>({1, 1, 2, 2, 2, 2}));
+    CHECK_EQ(image.slice(0x11, 0x13).byte_count(), 2u);
+}
+
+TEST(blank_blocks_are_left_out) {
+    const Image image = sample_image();
+    const Image part = image.without_blank_blocks(kProgramBlockSize, 0x1000, 0x8000);
+    // 0x1200-0x12FF is eight blank blocks, so the section splits around it
+    CHECK(part.segments().count(0x1000) == 1 && part.segments().at(0x1000).size() == 0x200);
+    CHECK(part.segments().count(0x1300) == 1);
+    CHECK_EQ(part.byte_count(), image.byte_count() - 0x100);
+
+    // Fewer than min_run blank blocks stay in
+    Image small = sample_image();
+    const std::vector<uint8_t> ff(0x60, 0xFF);
+    small.write(0x1600, ff.data(), ff.size());
+    CHECK(small.without_blank_blocks(kProgramBlockSize, 0x1000, 0x8000).segments().count(0x1660) == 0);
+}
+
+TEST(image_file_round_trip) {
+    const Image image = sample_image();
+    TempFile file("round-trip.sk28img");
+    write_image_file(image, file.path());
+    CHECK(is_image_file(file.path()));
+    const ImageFile mapped(file.path());
+    CHECK(same(mapped.to_image(), image));
+    CHECK(same(read_image(file.path()), image));
+    // Every row's CRC is that of its 64 bytes
+    for (size_t i = 0; i < mapped.row_count(); ++i) {
+        const ImageFile::Row row = mapped.row(i);
+        CHECK_EQ(row.address % kEraseRowSize, 0u);
+        CHECK_EQ(row.crc, crc16_ccitt(row.bytes, kEraseRowSize));
+    }
+    CHECK_EQ(mapped.regions().size(), 3u);  // Program, Config, EEPROM
+}
+
+TEST(corrupted_image_file_is_refused) {
+    std::vector<uint8_t> bytes = to_image_file(sample_image());
+    TempFile file("corrupted.sk28img");
+    // A flipped data byte fails its row's CRC, a flipped header byte the header's
+    for (size_t at : {bytes.size() - 1, size_t{12}}) {
+        std::vector<uint8_t> bad = bytes;
+        bad[at] ^= 0x01;
+        file.write(std::string(bad.begin(), bad.end()));
+        CHECK_THROWS(ImageFile mapped(file.path()), ImageError);
+    }
+    file.write(std::string(bytes.begin(), bytes.begin() + bytes.size() - 1));
+    CHECK_THROWS(ImageFile mapped(file.path()), ImageError);
+}
+
+TEST(view_of_an_image_file) {
+    const Image image = sample_image();
+    TempFile file("view.sk28img");
+    write_image_file(image, file.path());
+    const ImageFile mapped(file.path());
+    const ImageView view = mapped;
+    // Runs straight out of the rows, across row boundaries, the same as the image's segments
+    CHECK(same(view, image));
+    CHECK_EQ(fingerprint(view), fingerprint(image));
+    const ImageFile::Row row = *mapped.find_row(0x0800);
+    CHECK(view.runs().front().data == row.bytes);
+    CHECK(!mapped.find_row(0x1040 - 1));
+    CHECK(!mapped.find_row(0x4000));
+
+    uint16_t crc;
+    uint64_t present;
+    CHECK(view.stored_row(0x1800, crc, present));
+    CHECK_EQ(crc, crc16_ccitt(mapped.find_row(0x1800)->bytes, kEraseRowSize));
+    CHECK_EQ(present, 0xFF00FFFFFFFF0000ull);  // 0x1810-0x182F and 0x1838-0x183F
+    CHECK(!ImageView(image).stored_row(0x1800, crc, present));
+}
+
+TEST(view_slices_and_blank_blocks) {
+    const Image image = sample_image();
+    const ImageView view = image;
+    CHECK(same(view.slice(0x1100, 0x1900), image.slice(0x1100, 0x1900)));
+    Image both = image.slice(0x1000, 0x1010);
+    const Image eeprom = image.slice(0xF00000, 0xF00100);
+    both.write(0xF00000, eeprom.segments().begin()->second.data(), eeprom.segments().begin()->second.size());
+    CHECK(same(view.slices({{0xF00000, 0xF00010}, {0x1000, 0x1010}}), both));
+    CHECK(same(view.without_blank_blocks(kProgramBlockSize, 0x1000, 0x8000),
+               image.without_blank_blocks(kProgramBlockSize, 0x1000, 0x8000)));
+}
+
+TEST(view_written_over) {
+    const Image image = sample_image();
+    TempFile file("stamped.sk28img");
+    write_image_file(image, file.path());
+    const ImageFile mapped(file.path());
+    const uint8_t id[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    const uint8_t patch[] = {0xAA, 0xBB};
+
+    Image expected = image;
+    expected.write(0x200000, id, sizeof id);
+    expected.write(0x182F, patch, sizeof patch);  // Joins 0x1810-0x182F, and fills 0x1830 in
+    const ImageView view = ImageView(mapped).with(0x200000, id, sizeof id).with(0x182F, patch, sizeof patch);
+    CHECK(same(view, expected));
+    CHECK(same(ImageView(mapped), image));  // Left as it was
+
+    uint16_t crc;
+    uint64_t present;
+    CHECK(!view.stored_row(0x1800, crc, present));  // Written over
+    CHECK(view.stored_row(0x1840, crc, present));
+}
@@ -0,0 +1,132 @@
+#include <cstring>
+#include <vector>
+
+#include "check.h"
+#include "sk28a/protocol.h"
+
+using namespace sk28a;
+
+namespace {
+
+// What ExpandCompressedPacket() does with a PROGRAM_COMPRESSED payload
+std::vector<uint8_t> packbits_decode(const std::vector<uint8_t>& in) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i < in.size();) {
+        const uint8_t header = in[i++];
+        if (header < 128) {
+            out.insert(out.end(), in.begin() + i, in.begin() + i + header + 1);
+            i += header + 1;
+        } else if (header > 128) {
+            out.insert(out.end(), 257 - header, in[i++]);
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(data_packet_is_right_justified) {
+    const uint8_t data[] = {1, 2, 3};
+    const Packet p = make_data_packet(Command::ProgramDevice, 0x123456, data, sizeof data);
+    CHECK_EQ(p.u8(offset::kCommand), 0x05);
+    CHECK_EQ(p.bytes[1], 0x56);  // Little endian
+    CHECK_EQ(p.address(), 0x123456u);
+    CHECK_EQ(p.size(), 3);
+    CHECK_EQ(p.bytes[kPacketSize - 3], 1);
+    CHECK_EQ(p.bytes[kPacketSize - 1], 3);
+    CHECK(std::memcmp(p.payload(), data, sizeof data) == 0);
+}
+
+TEST(oversize_data_packet_throws) {
+    const std::vector<uint8_t> data(kDataBlockSize + 1);
+    CHECK_THROWS(make_data_packet(Command::ProgramDevice, 0x1000, data.data(), data.size()), ProtocolError);
+}
+
+TEST(range_packet_fields) {
+    const Packet p = make_range(Command::VerifyRange, 0x1000, 0x7000);
+    CHECK_EQ(p.command(), Command::VerifyRange);
+    CHECK_EQ(p.address(), 0x1000u);
+    CHECK_EQ(p.u32(offset::kLength), 0x7000u);
+}
+
+TEST(crc16_check_value) {
+    const char text[] = "123456789";
+    CHECK_EQ(crc16_ccitt(reinterpret_cast<const uint8_t*>(text), 9), 0x29B1);
+    // Continuing a CRC over a second part gives the CRC of the whole
+    const uint16_t first = crc16_ccitt(reinterpret_cast<const uint8_t*>(text), 4);
+    CHECK_EQ(crc16_ccitt(reinterpret_cast<const uint8_t*>(text) + 4, 5, first), 0x29B1);
+}
+
+TEST(crc16_combine) {
+    std::vector<uint8_t> data(1000);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i * 13 + 7);
+    for (size_t split : {size_t{0}, size_t{1}, size_t{64}, size_t{999}, size_t{1000}}) {
+        const uint16_t a = crc16_ccitt(data.data(), split);
+        const uint16_t b = crc16_ccitt(data.data() + split, data.size() - split);
+        CHECK_EQ(crc16_ccitt_combine(a, b, data.size() - split), crc16_ccitt(data.data(), data.size()));
+    }
+}
+
+TEST(packbits_round_trip) {
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 40; ++i)
+        data.push_back(static_cast<uint8_t>(i * 7));
+    data.insert(data.end(), 200, 0x00);
+    data.insert(data.end(), {1, 1, 2, 2, 3, 3, 3, 4});
+    data.insert(data.end(), 130, 0xFF);
+
+    // Packet by packet, as the flasher sends them
+    std::vector<uint8_t> decoded;
+    for (size_t at = 0; at < data.size();) {
+        std::vector<uint8_t> encoded;
+        const size_t taken = packbits_encode(data.data() + at, data.size() - at, kDataBlockSize, encoded);
+        CHECK(taken > 0);
+        CHECK(encoded.size() <= kDataBlockSize);
+        const std::vector<uint8_t> part = packbits_decode(encoded);
+        CHECK_EQ(part.size(), taken);
+        decoded.insert(decoded.end(), part.begin(), part.end());
+        at += taken;
+    }
+    CHECK(decoded == data);
+}
+
+TEST(packbits_compresses_runs) {
+    const std::vector<uint8_t> zeros(300, 0);
+    std::vector<uint8_t> encoded;
+    CHECK_EQ(packbits_encode(zeros.data(), zeros.size(), kDataBlockSize, encoded), zeros.size());
+    CHECK_EQ(encoded.size(), 6u);  // 128 + 128 + 44
+}
+
+TEST(query_response) {
+    Packet p = make_command(Command::QueryDevice);
+    p.bytes[1] = 56;
+    p.bytes[2] = 1;
+    p.bytes[3] = 0x01;
+    p.set_u32(4, 0x1000);
+    p.set_u32(8, 0x7000);
+    p.bytes[12] = 0x02;
+    p.set_u32(13, 0xF00000);
+    p.set_u32(17, 0x100);
+    p.bytes[21] = 0xFF;
+    p.set_u16(57, feature::kVerifyRange | feature::kFill);
+    const DeviceInfo info = parse_query_response(p);
+    CHECK_EQ(info.packet_data_field_size, 56);
+    CHECK_EQ(info.regions.size(), 2u);
+    CHECK(info.region_at(0x7FFF) != nullptr && info.region_at(0x7FFF)->type == MemoryType::Program);
+    CHECK(info.region_at(0x8000) == nullptr);
+    CHECK(info.has(feature::kFill));
+    CHECK(!info.has(feature::kReadStream));
+}
+
+TEST(serial_numbers) {
+    UserId id;
+    CHECK(parse_serial_number("1F", id));
+    CHECK_EQ(serial_number(id), "000000000000001F");
+    CHECK_EQ(serial_number(next_serial_number(id)), "0000000000000020");
+    CHECK(parse_serial_number("FFFFFFFFFFFFFFFF", id));
+    CHECK_EQ(serial_number(next_serial_number(id)), "0000000000000000");
+    CHECK(!parse_serial_number("", id));
+    CHECK(!parse_serial_number("12G4", id));
+    CHECK(!parse_serial_number("00000000000000001", id));
+}
@@ -0,0 +1,195 @@
+// Flasher::flash(image, journal) picking up after the board went away halfway
+// through, against the firmware (built per variant, like firmware_test.cpp)
+#include <cstdio>
+#include <vector>
+
+#include "check.h"
+#include "samples.h"
+#include "sk28a/firmware_device.h"
+#include "sk28a/flasher.h"
+#include "sk28a/journal.h"
+
+using namespace sk28a;
+using sk28a_test::first_difference;
+using sk28a_test::kAllMatch;
+using sk28a_test::sample_image;
+using sk28a_test::TempFile;
+
+namespace {
+
+// Gives out after `writes` reports, like a board unplugged mid-transfer
+class Unplugged : public Transport {
+public:
+    Unplugged(Transport& to, unsigned writes) : to_(to), writes_(writes) {}
+
+    void write(const Packet& packet) override {
+        if (written_ == writes_)
+            throw TransportError("unplugged");
+        ++written_;
+        to_.write(packet);
+    }
+    bool read(Packet& packet, std::chrono::milliseconds timeout) override { return to_.read(packet, timeout); }
+    std::string description() const override { return "unplugged " + to_.description(); }
+
+    unsigned written() const { return written_; }
+
+private:
+    Transport& to_;
+    unsigned writes_;
+    unsigned written_ = 0;
+};
+
+// Plugged back in: the bootloader starts over, with nothing of the last session pending
+void replug(FirmwareDevice& device) {
+    Packet p;
+    while (device.read(p, std::chrono::milliseconds(5))) {
+    }
+    device.write(make_command(Command::ResetDevice));
+    while (device.read(p, std::chrono::milliseconds(5))) {
+    }
+}
+
+bool exists(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "r");
+    if (f != nullptr)
+        std::fclose(f);
+    return f != nullptr;
+}
+
+FlashOptions with(EraseMode erase, VerifyMode verify) {
+    FlashOptions options;
+    options.erase = erase;
+    options.verify = verify;
+    return options;
+}
+
+uint16_t features() {
+    FirmwareDevice device;
+    Flasher flasher(device);
+    return flasher.query().extended_features;
+}
+
+// The resumable erase modes, and the verify modes, this build has
+std::vector<FlashOptions> resumable(uint16_t available) {
+    std::vector<EraseMode> erase = {EraseMode::Full};
+    if (available & feature::kEraseRange)
+        erase.push_back(EraseMode::Range);
+    if (available & feature::kLazyErase)
+        erase.push_back(EraseMode::Lazy);
+    std::vector<FlashOptions> out;
+    for (EraseMode e : erase) {
+        out.push_back(with(e, VerifyMode::Read));
+        if (available & feature::kVerifyRange)
+            out.push_back(with(e, VerifyMode::Crc));
+    }
+    return out;
+}
+
+// A board that had another application on it
+void dirty(FirmwareDevice& device) {
+    for (uint32_t a = 0x1000; a < 0x8000; ++a)
+        device.poke(a, 0x5A);
+}
+
+// Reports a journaled run writes when nothing goes wrong
+unsigned writes_to_flash(const Image& image, const FlashOptions& options) {
+    TempFile path("count.journal");
+    Journal journal(path.path());
+    FirmwareDevice device;
+    dirty(device);
+    Unplugged link(device, ~0u);
+    Flasher(link, options).flash(image, journal);
+    return link.written();
+}
+
+}  // namespace
+
+TEST(resume_after_unplug) {
+    const Image image = sample_image();
+    for (const FlashOptions& options : resumable(features())) {
+        // From during the erase to the last chunk
+        const unsigned total = writes_to_flash(image, options);
+        bool resumed_part_way = false;
+        for (unsigned writes : {3u, total / 5, total / 2, total * 4 / 5, total - 3}) {
+            TempFile path("resume.journal");
+            Journal journal(path.path());
+            FirmwareDevice device;
+            dirty(device);
+            {
+                Unplugged link(device, writes);
+                Flasher flasher(link, options);
+                CHECK_THROWS(flasher.flash(image, journal), TransportError);
+            }
+            CHECK(exists(path.path()));
+            replug(device);
+
+            Flasher flasher(device, options);
+            const uint64_t already = flasher.flash(image, journal);
+            CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+            CHECK(!exists(path.path()));
+            resumed_part_way |= already > 0;
+        }
+        CHECK(resumed_part_way);
+    }
+}
+
+TEST(resume_reprograms_what_no_longer_checks_out) {
+    const Image image = sample_image();
+    for (const FlashOptions& options : resumable(features())) {
+        const unsigned total = writes_to_flash(image, options);
+        TempFile path("damaged.journal");
+        Journal journal(path.path());
+        FirmwareDevice device;
+        dirty(device);
+        {
+            Unplugged link(device, total * 3 / 4);
+            Flasher flasher(link, options);
+            CHECK_THROWS(flasher.flash(image, journal), TransportError);
+        }
+        replug(device);
+        // Below what the journal has as done
+        device.poke(0x1010, static_cast<uint8_t>(device.peek(0x1010) ^ 0x01));
+
+        Flasher flasher(device, options);
+        flasher.flash(image, journal);
+        CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+    }
+}
+
+TEST(journal_for_another_image_is_ignored) {
+    TempFile path("other.journal");
+    Journal journal(path.path());
+    journal.start(0x0123456789ABCDEF, 0x2000);
+    FirmwareDevice device;
+    dirty(device);
+    Flasher flasher(device, with(EraseMode::Full, VerifyMode::Read));
+    const Image image = sample_image();
+    CHECK_EQ(flasher.flash(image, journal), 0u);
+    CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+    CHECK(!exists(path.path()));
+}
+
+TEST(resume_from_image_file) {
+    // Started from the hex file's image and picked up from the .sk28img made of it: the journal is the same
+    const Image image = sample_image();
+    TempFile file("resume.sk28img");
+    write_image_file(image, file.path());
+    const ImageFile mapped(file.path());
+    for (const FlashOptions& options : resumable(features())) {
+        const unsigned total = writes_to_flash(image, options);
+        TempFile path("file.journal");
+        Journal journal(path.path());
+        FirmwareDevice device;
+        dirty(device);
+        {
+            Unplugged link(device, total * 3 / 4);
+            Flasher flasher(link, options);
+            CHECK_THROWS(flasher.flash(image, journal), TransportError);
+        }
+        replug(device);
+
+        Flasher flasher(device, options);
+        CHECK(flasher.flash(mapped, journal) > 0);
+        CHECK_EQ(first_difference(device, flasher.writable_part(image)), kAllMatch);
+    }
+}
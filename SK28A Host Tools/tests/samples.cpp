@@ -0,0 +1,106 @@
+#include "samples.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace sk28a_test {
+
+namespace {
+
+void add(sk28a::Image& to, const sk28a::Image& from) {
+    for (const auto& [address, bytes] : from.segments())
+        to.write(address, bytes.data(), bytes.size());
+}
+
+}  // namespace
+
+sk28a::Image noise(uint32_t address, size_t size, uint32_t seed) {
+    std::string bytes(size, '\0');
+    for (char& b : bytes) {
+        seed = seed * 1103515245 + 12345;
+        b = static_cast<char>(seed >> 16);
+    }
+    sk28a::Image image;
+    image.write(address, reinterpret_cast<const uint8_t*>(bytes.data()), size);
+    return image;
+}
+
+sk28a::Image run(uint32_t address, size_t size, uint8_t value) {
+    const std::string bytes(size, static_cast<char>(value));
+    sk28a::Image image;
+    image.write(address, reinterpret_cast<const uint8_t*>(bytes.data()), size);
+    return image;
+}
+
+sk28a::Image sample_image() {
+    sk28a::Image image;
+    add(image, noise(0x0800, 0x20, 1));     // Bootloader block
+    add(image, noise(0x1000, 0x800, 2));
+    add(image, run(0x1200, 0x100, 0xFF));   // Blank blocks inside the section
+    add(image, run(0x1400, 0x90, 0x00));    // Short padding
+    add(image, noise(0x1810, 0x20, 3));     // Ends inside row 0x1800 ...
+    add(image, noise(0x1838, 0x108, 4));    // ... where this one starts
+    add(image, run(0x2000, 0x1000, 0x00));  // Long padding
+    add(image, noise(0x3000, 0x44, 5));
+    add(image, noise(0xF00000, 0x10, 6));   // EEPROM
+    add(image, noise(0xF00080, 0x04, 7));
+    const uint8_t config[] = {0x24, 0x0E, 0x3F, 0x1E, 0xFF, 0x81, 0xFF, 0xFF,
+                              0x0F, 0xC0, 0x0F, 0xE0, 0x0F, 0x40};
+    image.write(0x300000, config, sizeof config);
+    return image;
+}
+
+std::string to_hex(const sk28a::Image& image) {
+    std::string out;
+    auto record = [&out](uint8_t type, uint16_t address, const uint8_t* data, size_t size) {
+        char buf[16];
+        unsigned sum = static_cast<unsigned>(size) + (address >> 8) + (address & 0xFF) + type;
+        std::snprintf(buf, sizeof buf, ":%02X%04X%02X", static_cast<unsigned>(size), address, type);
+        out += buf;
+        for (size_t i = 0; i < size; ++i) {
+            std::snprintf(buf, sizeof buf, "%02X", data[i]);
+            out += buf;
+            sum += data[i];
+        }
+        std::snprintf(buf, sizeof buf, "%02X\n", (0x100 - (sum & 0xFF)) & 0xFF);
+        out += buf;
+    };
+    uint32_t upper = 0;
+    for (const auto& [start, bytes] : image.segments()) {
+        for (size_t at = 0; at < bytes.size();) {
+            const uint32_t address = start + static_cast<uint32_t>(at);
+            if (address >> 16 != upper) {
+                upper = address >> 16;
+                const uint8_t ela[] = {static_cast<uint8_t>(upper >> 8), static_cast<uint8_t>(upper)};
+                record(0x04, 0, ela, 2);
+            }
+            // Records don't cross a 64 KB boundary
+            size_t n = std::min<size_t>(16, bytes.size() - at);
+            n = std::min<size_t>(n, 0x10000 - (address & 0xFFFF));
+            record(0x00, static_cast<uint16_t>(address), bytes.data() + at, n);
+            at += n;
+        }
+    }
+    record(0x01, 0, nullptr, 0);
+    return out;
+}
+
+TempFile::TempFile(const std::string& name) {
+    const char* dir = std::getenv("TMPDIR");
+    path_ = std::string(dir != nullptr && *dir != '\0' ? dir : "/tmp") + "/sk28a-test-" +
+            std::to_string(::getpid()) + "-" + name;
+    std::remove(path_.c_str());
+}
+
+TempFile::~TempFile() { std::remove(path_.c_str()); }
+
+void TempFile::write(const std::string& text) const {
+    std::FILE* f = std::fopen(path_.c_str(), "wb");
+    if (f == nullptr || std::fwrite(text.data(), 1, text.size(), f) != text.size() || std::fclose(f) != 0)
+        throw std::runtime_error("cannot write " + path_);
+}
+
+}  // namespace sk28a_test
@@ -0,0 +1,60 @@
+// Images for the tests to flash
+#ifndef SK28A_TESTS_SAMPLES_H
+#define SK28A_TESTS_SAMPLES_H
+
+#include <cstdint>
+#include <string>
+
+#include "sk28a/image.h"
+#include "sk28a/protocol.h"
+
+namespace sk28a_test {
+
+// An application with what the flasher treats specially: bytes in the
+// bootloader's block (never sent), a run of blank blocks inside a section,
+// 0x00 padding short and long, a section ending inside the row the next one
+// starts in, EEPROM bytes and config words.
+sk28a::Image sample_image();
+
+// Pseudo-random bytes, the same for the same seed
+sk28a::Image noise(uint32_t address, size_t size, uint32_t seed);
+sk28a::Image run(uint32_t address, size_t size, uint8_t value);
+
+// Where a SimDevice or FirmwareDevice first doesn't hold what the image has
+// there (config words aside, which read back differently), or kAllMatch
+constexpr uint32_t kAllMatch = 0xFFFFFFFF;
+template <typename Device>
+uint32_t first_difference(const Device& device, const sk28a::ImageView& image) {
+    for (const sk28a::ImageView::Run& run : image.runs()) {
+        if (sk28a::is_config_address(run.address))
+            continue;
+        for (size_t i = 0; i < run.size; ++i) {
+            const uint32_t a = run.address + static_cast<uint32_t>(i);
+            if (device.peek(a) != run.data[i])
+                return a;
+        }
+    }
+    return kAllMatch;
+}
+
+// Intel HEX text, 16 bytes per record
+std::string to_hex(const sk28a::Image& image);
+
+// A file in the temporary directory, removed again when this goes
+class TempFile {
+public:
+    explicit TempFile(const std::string& name);
+    ~TempFile();
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    void write(const std::string& text) const;
+
+private:
+    std::string path_;
+};
+
+}  // namespace sk28a_test
+
+#endif  // SK28A_TESTS_SAMPLES_H
@@ -0,0 +1,249 @@
+// sk28a-bench: flashes images into the host build of the firmware and reports,
+// as JSON, how long each step would take on a board (see FirmwareDevice)
+#include <getopt.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sk28a/firmware_device.h"
+#include "sk28a/flasher.h"
+#include "sk28a/image.h"
+
+namespace {
+
+void usage(FILE* out) {
+    std::fprintf(out,
+                 "Usage: sk28a-bench [options] IMAGE...\n"
+                 "\n"
+                 "Erases, programs, verifies and resets the host build of the bootloader firmware once per image,\n"
+                 "and writes the predicted time of each step on a board as JSON.  Images are hex or .sk28img files.\n"
+                 "\n"
+                 "Options:\n"
+                 "      --erase MODE    full (default), range, lazy, none or patch\n"
+                 "      --verify MODE   read (default), crc or none\n"
+                 "      --no-config     leave the configuration words out\n"
+                 "      --window N      requests kept in flight while reading back (default 4)\n"
+                 "  -o, --output FILE   write the JSON to FILE instead of stdout\n"
+                 "  -h, --help\n");
+}
+
+// In the order of the EraseMode and VerifyMode enumerators
+const char* const kEraseModes[] = {"full", "range", "lazy", "none", "patch"};
+const char* const kVerifyModes[] = {"read", "crc", "none"};
+
+template <typename Mode, size_t N>
+bool parse_mode(const char* s, const char* const (&names)[N], Mode& mode) {
+    for (size_t i = 0; i < N; ++i) {
+        if (std::strcmp(s, names[i]) == 0) {
+            mode = static_cast<Mode>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof escape, "\\u%04x", static_cast<unsigned>(c));
+            out += escape;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string base_name(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+struct Result {
+    std::string image;
+    size_t bytes = 0;
+    std::chrono::microseconds erase{0};
+    std::chrono::microseconds program{0};
+    std::chrono::microseconds verify{0};
+    std::chrono::microseconds reset{0};
+    std::chrono::microseconds writes{0};
+    std::chrono::microseconds naking{0};
+    uint64_t naks = 0;
+    uint64_t reports_sent = 0;
+    uint64_t reports_received = 0;
+    sk28a::ProgramStats program_stats;
+    uint16_t extended_features = 0;
+};
+
+// One image on a freshly powered part.  QUERY_DEVICE is not counted, the
+// steps after it are timed on the part's clock.
+Result run(const std::string& path, const sk28a::FlashOptions& options) {
+    Result result;
+    result.image = base_name(path);
+    const sk28a::ImageSource source(path);
+    const sk28a::ImageView& image = source.view();
+
+    sk28a::FirmwareDevice device;
+    sk28a::Flasher flasher(device, options);
+    result.extended_features = flasher.query().extended_features;
+    result.bytes = flasher.writable_part(image).byte_count();
+    if (result.bytes == 0)
+        throw sk28a::ProtocolError("the image has nothing in the memory ranges this device reports");
+
+    const auto stats_before = device.stats();
+    const auto writes_before = device.write_time();
+    const auto naking_before = device.nak_time();
+    const auto naks_before = device.nak_count();
+    auto mark = device.virtual_time();
+    auto lap = [&](std::chrono::microseconds& step) {
+        const auto now = device.virtual_time();
+        step = now - mark;
+        mark = now;
+    };
+    flasher.erase(image);
+    lap(result.erase);
+    flasher.program(image);
+    lap(result.program);
+    result.program_stats = flasher.program_stats();
+    flasher.verify(image);
+    lap(result.verify);
+    if (options.reset) {
+        flasher.reset();
+        lap(result.reset);
+    }
+    result.writes = device.write_time() - writes_before;
+    result.naking = device.nak_time() - naking_before;
+    result.naks = device.nak_count() - naks_before;
+    result.reports_sent = device.stats().reports_written - stats_before.reports_written;
+    result.reports_received = device.stats().reports_read - stats_before.reports_read;
+    return result;
+}
+
+void write_json(FILE* out, const sk28a::FlashOptions& options, const std::vector<Result>& results) {
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"device\": %s,\n", json_string("host build of the bootloader firmware").c_str());
+    std::fprintf(out, "  \"erase\": \"%s\",\n", kEraseModes[static_cast<int>(options.erase)]);
+    std::fprintf(out, "  \"verify\": \"%s\",\n", kVerifyModes[static_cast<int>(options.verify)]);
+    std::fprintf(out, "  \"config\": %s,\n", options.program_config ? "true" : "false");
+    std::fprintf(out, "  \"images\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const auto total = r.erase + r.program + r.verify + r.reset;
+        const double seconds = std::chrono::duration<double>(total).count();
+        std::fprintf(out, "%s\n    {\n", i == 0 ? "" : ",");
+        std::fprintf(out, "      \"image\": %s,\n", json_string(r.image).c_str());
+        std::fprintf(out, "      \"extended_features\": %u,\n", static_cast<unsigned>(r.extended_features));
+        std::fprintf(out, "      \"bytes\": %zu,\n", r.bytes);
+        std::fprintf(out, "      \"erase_us\": %lld,\n", static_cast<long long>(r.erase.count()));
+        std::fprintf(out, "      \"program_us\": %lld,\n", static_cast<long long>(r.program.count()));
+        std::fprintf(out, "      \"verify_us\": %lld,\n", static_cast<long long>(r.verify.count()));
+        std::fprintf(out, "      \"reset_us\": %lld,\n", static_cast<long long>(r.reset.count()));
+        std::fprintf(out, "      \"total_us\": %lld,\n", static_cast<long long>(total.count()));
+        std::fprintf(out, "      \"write_wait_us\": %lld,\n", static_cast<long long>(r.writes.count()));
+        std::fprintf(out, "      \"reports_sent\": %llu,\n", static_cast<unsigned long long>(r.reports_sent));
+        std::fprintf(out, "      \"reports_received\": %llu,\n", static_cast<unsigned long long>(r.reports_received));
+        std::fprintf(out, "      \"program_payload_bytes\": %llu,\n",
+                     static_cast<unsigned long long>(r.program_stats.payload));
+        std::fprintf(out, "      \"compressed_packets\": %llu,\n",
+                     static_cast<unsigned long long>(r.program_stats.compressed_packets));
+        std::fprintf(out, "      \"fill_packets\": %llu,\n",
+                     static_cast<unsigned long long>(r.program_stats.fill_packets));
+        std::fprintf(out, "      \"compression_ratio\": %.3f,\n", r.program_stats.ratio());
+        std::fprintf(out, "      \"bytes_per_s\": %.1f,\n", seconds > 0 ? r.bytes / seconds : 0.0);
+        std::fprintf(out, "      \"naks\": %llu,\n", static_cast<unsigned long long>(r.naks));
+        std::fprintf(out, "      \"nak_share\": %.4f\n",
+                     total.count() > 0 ? static_cast<double>(r.naking.count()) / total.count() : 0.0);
+        std::fprintf(out, "    }");
+    }
+    std::fprintf(out, "%s]\n}\n", results.empty() ? "" : "\n  ");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    enum { kOptErase = 256, kOptVerify, kOptNoConfig, kOptWindow };
+    static const option long_options[] = {
+        {"erase", required_argument, nullptr, kOptErase},
+        {"verify", required_argument, nullptr, kOptVerify},
+        {"no-config", no_argument, nullptr, kOptNoConfig},
+        {"window", required_argument, nullptr, kOptWindow},
+        {"output", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    sk28a::FlashOptions options;
+    options.program_config = true;  // The bootloader's own image has nothing else the bootloader can write
+    std::string output;
+    int c;
+    while ((c = getopt_long(argc, argv, "o:h", long_options, nullptr)) != -1) {
+        switch (c) {
+        case kOptErase:
+            if (!parse_mode(optarg, kEraseModes, options.erase)) {
+                std::fprintf(stderr, "sk28a-bench: unknown erase mode '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case kOptVerify:
+            if (!parse_mode(optarg, kVerifyModes, options.verify)) {
+                std::fprintf(stderr, "sk28a-bench: unknown verify mode '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case kOptNoConfig:
+            options.program_config = false;
+            break;
+        case kOptWindow:
+            options.window = static_cast<unsigned>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 2;
+        }
+    }
+    if (optind == argc) {
+        usage(stderr);
+        return 2;
+    }
+
+    std::vector<Result> results;
+    for (int i = optind; i < argc; ++i) {
+        try {
+            results.push_back(run(argv[i], options));
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "sk28a-bench: %s: %s\n", argv[i], e.what());
+            return 1;
+        }
+    }
+
+    FILE* out = stdout;
+    if (!output.empty()) {
+        out = std::fopen(output.c_str(), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "sk28a-bench: cannot write %s: %s\n", output.c_str(), std::strerror(errno));
+            return 1;
+        }
+    }
+    write_json(out, options, results);
+    if (out != stdout && std::fclose(out) != 0) {
+        std::fprintf(stderr, "sk28a-bench: cannot write %s: %s\n", output.c_str(), std::strerror(errno));
+        return 1;
+    }
+    return 0;
+}
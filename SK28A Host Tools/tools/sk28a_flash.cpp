@@ -0,0 +1,453 @@
+// sk28a-flash: command line replacement for HIDBootLoader.exe
+#include <getopt.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sk28a/board_pool.h"
+#include "sk28a/firmware_device.h"
+#include "sk28a/flasher.h"
+#include "sk28a/hidraw_transport.h"
+#include "sk28a/image.h"
+#include "sk28a/journal.h"
+#include "sk28a/sim_device.h"
+#if defined(SK28A_HAVE_LIBUSB)
+#include "sk28a/libusb_transport.h"
+#endif
+
+namespace {
+
+void usage(FILE* out) {
+    std::fprintf(out,
+                 "Usage: sk28a-flash [options] IMAGE\n"
+                 "       sk28a-flash --all [options] IMAGE\n"
+                 "       sk28a-flash --serial S [options] [IMAGE]\n"
+                 "       sk28a-flash --list\n"
+                 "\n"
+                 "Erases, programs and verifies an SK28A board in bootloader mode, then resets it.\n"
+                 "IMAGE is an Intel HEX file or an .sk28img file made by sk28a-image.\n"
+                 "\n"
+                 "Options:\n"
+                 "  -d, --device DEV    hidraw node, usb:BUS-PORT of a vendor class (bulk) board, or serial number\n"
+                 "                      of the board (default: the first bootloader found); give it several\n"
+                 "                      times to flash several boards at once\n"
+                 "  -a, --all           flash every bootloader found, all at once, in port order\n"
+                 "  -j, --jobs N        flash at most N boards at a time (default: all of them)\n"
+                 "      --sim           flash a simulated PIC18F2550 instead of a board\n"
+                 "      --firmware-sim  flash the bootloader firmware built for the host instead of a board\n"
+                 "  -l, --list          list the bootloaders that are connected\n"
+                 "      --erase MODE    full (default), range, lazy, none or patch (rewrite only the flash rows the\n"
+                 "                      image touches, keeping the rest of their bytes)\n"
+                 "      --verify MODE   read (default), crc or none\n"
+                 "      --config        also program the configuration words\n"
+                 "      --serial S      write serial number S (up to 16 hex digits) into the User ID, S+1 into the\n"
+                 "                      next board's and so on; without IMAGE, only that (--erase defaults to range)\n"
+                 "      --journal PATH  keep a progress journal in PATH, and resume from it if a run for the same\n"
+                 "                      image was interrupted; with several boards, a directory with a journal per\n"
+                 "                      port\n"
+                 "      --no-reset      stay in the bootloader afterwards\n"
+                 "      --window N      requests kept in flight while reading back (default 4)\n"
+                 "  -q, --quiet         no progress output\n"
+                 "  -h, --help\n");
+}
+
+bool parse_erase_mode(const char* s, sk28a::EraseMode& mode) {
+    if (std::strcmp(s, "full") == 0)
+        mode = sk28a::EraseMode::Full;
+    else if (std::strcmp(s, "range") == 0)
+        mode = sk28a::EraseMode::Range;
+    else if (std::strcmp(s, "lazy") == 0)
+        mode = sk28a::EraseMode::Lazy;
+    else if (std::strcmp(s, "none") == 0)
+        mode = sk28a::EraseMode::None;
+    else if (std::strcmp(s, "patch") == 0)
+        mode = sk28a::EraseMode::Patch;
+    else
+        return false;
+    return true;
+}
+
+bool parse_verify_mode(const char* s, sk28a::VerifyMode& mode) {
+    if (std::strcmp(s, "read") == 0)
+        mode = sk28a::VerifyMode::Read;
+    else if (std::strcmp(s, "crc") == 0)
+        mode = sk28a::VerifyMode::Crc;
+    else if (std::strcmp(s, "none") == 0)
+        mode = sk28a::VerifyMode::None;
+    else
+        return false;
+    return true;
+}
+
+// A connected bootloader: a hidraw node for the HID build, a usb:BUS-PORT path for the vendor class bulk build
+struct Bootloader {
+    std::string path;
+    std::string phys;  // Port it sits on
+    std::string uniq;  // Serial number string, empty if it has none
+};
+
+// The HID builds first, then (if built with libusb) the boards whose interface 0 is vendor class
+std::vector<Bootloader> find_bootloaders() {
+    std::vector<Bootloader> found;
+    for (const auto& dev : sk28a::find_hidraw_devices())
+        found.push_back(Bootloader{dev.path, dev.phys, dev.uniq});
+#if defined(SK28A_HAVE_LIBUSB)
+    for (const auto& dev : sk28a::find_libusb_devices())
+        found.push_back(Bootloader{dev.path, dev.phys, dev.uniq});
+#endif
+    return found;
+}
+
+bool is_libusb_path(const std::string& path) { return path.rfind("usb:", 0) == 0; }
+
+std::unique_ptr<sk28a::Transport> open_bootloader(const std::string& path) {
+    if (is_libusb_path(path)) {
+#if defined(SK28A_HAVE_LIBUSB)
+        return std::make_unique<sk28a::LibusbTransport>(path);
+#else
+        throw std::runtime_error(path + ": this sk28a-flash was built without libusb, which the vendor class "
+                                        "bootloader needs");
+#endif
+    }
+    return std::make_unique<sk28a::HidrawTransport>(path);
+}
+
+int list_devices() {
+    const auto devices = find_bootloaders();
+    if (devices.empty()) {
+        std::fprintf(stderr, "no bootloader found (%04X:%04X)\n", sk28a::kVendorId, sk28a::kProductId);
+        return 1;
+    }
+    for (const auto& dev : devices)
+        std::printf("%s\t%s\t%s\n", dev.path.c_str(), dev.phys.c_str(), dev.uniq.c_str());
+    return 0;
+}
+
+// A -d argument: a hidraw node, a usb:BUS-PORT path, or the serial number of a connected bootloader
+Bootloader resolve_device(const std::string& arg, const std::vector<Bootloader>& found) {
+    for (const auto& dev : found) {
+        if (dev.path == arg || (!dev.uniq.empty() && strcasecmp(dev.uniq.c_str(), arg.c_str()) == 0))
+            return dev;
+    }
+    if (arg.find('/') == std::string::npos && !is_libusb_path(arg))
+        throw std::runtime_error("no bootloader with serial number " + arg);
+    return Bootloader{arg, {}, {}};
+}
+
+// A board's journal in the --journal directory, named after the port so it is found again once the board is back
+std::string board_journal(const std::string& dir, const Bootloader& dev) {
+    std::string name = dev.phys.empty() ? dev.path.substr(dev.path.rfind('/') + 1) : dev.phys;
+    for (char& ch : name) {
+        if (!std::isalnum(static_cast<unsigned char>(ch)) && ch != '.' && ch != '-')
+            ch = '_';
+    }
+    return dir + "/" + name + ".journal";
+}
+
+std::string board_label(const sk28a::BoardResult& r) {
+    return r.location.empty() ? r.name : r.name + " (" + r.location + ")";
+}
+
+// Several boards, one worker each, reported as each one finishes
+int flash_boards(const std::vector<Bootloader>& devices, const sk28a::ImageView& image,
+                 const sk28a::FlashOptions& options, std::optional<sk28a::UserId> serial,
+                 const std::string& journal_dir, unsigned jobs, bool quiet) {
+    if (!journal_dir.empty() && ::mkdir(journal_dir.c_str(), 0777) != 0 && errno != EEXIST)
+        throw sk28a::JournalError("cannot create " + journal_dir + ": " + std::strerror(errno));
+    std::vector<sk28a::BoardTarget> boards;
+    for (const auto& dev : devices) {
+        sk28a::BoardTarget board;
+        board.name = dev.path;
+        board.location = dev.phys;
+        board.open = [path = dev.path] { return open_bootloader(path); };
+        if (serial) {
+            board.user_id = serial;
+            serial = sk28a::next_serial_number(*serial);
+        }
+        if (!journal_dir.empty())
+            board.journal = board_journal(journal_dir, dev);
+        boards.push_back(std::move(board));
+    }
+
+    std::mutex output;
+    const auto start = std::chrono::steady_clock::now();
+    if (!quiet)
+        std::fprintf(stderr, "flashing %zu boards\n", boards.size());
+    const auto results = sk28a::flash_boards(
+        boards, image, options, jobs, {}, [&](size_t i, const sk28a::BoardResult& r) {
+            const std::lock_guard<std::mutex> lock(output);
+            const std::string stamped =
+                boards[i].user_id ? ", serial number " + sk28a::serial_number(*boards[i].user_id) : "";
+            const std::string resumed =
+                r.resumed != 0 ? " (resumed, " + std::to_string(r.resumed) + " were already there)" : "";
+            if (!r.ok)
+                std::fprintf(stderr, "%s: FAILED: %s\n", board_label(r).c_str(), r.error.c_str());
+            else if (!quiet)
+                std::fprintf(stderr, "%s: OK, %llu bytes in %.2f s%s%s\n", board_label(r).c_str(),
+                             static_cast<unsigned long long>(r.bytes), r.elapsed.count() / 1000.0, resumed.c_str(),
+                             stamped.c_str());
+        });
+
+    size_t ok = 0;
+    for (const auto& r : results)
+        ok += r.ok;
+    if (!quiet) {
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::fprintf(stderr, "%zu of %zu boards flashed in %.2f s\n", ok, results.size(), elapsed.count());
+    }
+    return ok == results.size() ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    enum {
+        kOptSim = 256,
+        kOptFirmwareSim,
+        kOptErase,
+        kOptVerify,
+        kOptConfig,
+        kOptSerial,
+        kOptJournal,
+        kOptNoReset,
+        kOptWindow
+    };
+    static const option long_options[] = {
+        {"device", required_argument, nullptr, 'd'},
+        {"all", no_argument, nullptr, 'a'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {"sim", no_argument, nullptr, kOptSim},
+        {"firmware-sim", no_argument, nullptr, kOptFirmwareSim},
+        {"list", no_argument, nullptr, 'l'},
+        {"erase", required_argument, nullptr, kOptErase},
+        {"verify", required_argument, nullptr, kOptVerify},
+        {"config", no_argument, nullptr, kOptConfig},
+        {"serial", required_argument, nullptr, kOptSerial},
+        {"journal", required_argument, nullptr, kOptJournal},
+        {"no-reset", no_argument, nullptr, kOptNoReset},
+        {"window", required_argument, nullptr, kOptWindow},
+        {"quiet", no_argument, nullptr, 'q'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    sk28a::FlashOptions options;
+    std::vector<std::string> devices;
+    bool all = false;
+    unsigned jobs = 0;
+    std::optional<sk28a::UserId> serial;
+    std::string journal_path;
+    bool erase_given = false;
+    bool sim = false;
+    bool firmware_sim = false;
+    bool quiet = false;
+    int c;
+    while ((c = getopt_long(argc, argv, "d:aj:lqh", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'd':
+            devices.push_back(optarg);
+            break;
+        case 'a':
+            all = true;
+            break;
+        case 'j':
+            jobs = static_cast<unsigned>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case kOptSim:
+            sim = true;
+            break;
+        case kOptFirmwareSim:
+            firmware_sim = true;
+            break;
+        case 'l':
+            return list_devices();
+        case kOptErase:
+            if (!parse_erase_mode(optarg, options.erase)) {
+                std::fprintf(stderr, "sk28a-flash: unknown erase mode '%s'\n", optarg);
+                return 2;
+            }
+            erase_given = true;
+            break;
+        case kOptVerify:
+            if (!parse_verify_mode(optarg, options.verify)) {
+                std::fprintf(stderr, "sk28a-flash: unknown verify mode '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case kOptConfig:
+            options.program_config = true;
+            break;
+        case kOptSerial:
+            serial.emplace();
+            if (!sk28a::parse_serial_number(optarg, *serial)) {
+                std::fprintf(stderr, "sk28a-flash: serial number '%s' isn't up to 16 hex digits\n", optarg);
+                return 2;
+            }
+            break;
+        case kOptJournal:
+            journal_path = optarg;
+            break;
+        case kOptNoReset:
+            options.reset = false;
+            break;
+        case kOptWindow:
+            options.window = static_cast<unsigned>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 2;
+        }
+    }
+    const bool several = all || devices.size() > 1;
+    const bool stamp_only = serial && optind == argc;
+    if ((optind + 1 != argc && !stamp_only) || (several && (sim || firmware_sim)) || (all && !devices.empty())) {
+        usage(stderr);
+        return 2;
+    }
+    if (stamp_only && !erase_given)
+        options.erase = sk28a::EraseMode::Range;  // ERASE_DEVICE would take the application with it
+    const std::string image_path = stamp_only ? std::string() : argv[optind];
+    // An .sk28img is flashed straight from its mapping, which stays open until the end
+    std::optional<sk28a::ImageSource> source;
+
+    if (several) {
+        try {
+            if (!stamp_only)
+                source.emplace(image_path);
+            const sk28a::ImageView image = source ? source->view() : sk28a::ImageView();
+            const auto found = find_bootloaders();
+            std::vector<Bootloader> boards;
+            if (all) {
+                // In port order, so serial numbers go out in the order the boards sit in the fixture
+                boards = found;
+                std::stable_sort(boards.begin(), boards.end(),
+                                 [](const Bootloader& a, const Bootloader& b) { return a.phys < b.phys; });
+                if (boards.empty()) {
+                    std::fprintf(stderr, "sk28a-flash: no bootloader found (%04X:%04X)\n", sk28a::kVendorId,
+                                 sk28a::kProductId);
+                    return 1;
+                }
+            } else {
+                for (const std::string& arg : devices)
+                    boards.push_back(resolve_device(arg, found));
+            }
+            return flash_boards(boards, image, options, serial, journal_path, jobs, quiet);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "sk28a-flash: %s\n", e.what());
+            return 1;
+        }
+    }
+
+    std::string last_phase;  // Progress line in use, for ending it before other output
+    try {
+        if (!stamp_only)
+            source.emplace(image_path);
+        sk28a::ImageView image = source ? source->view() : sk28a::ImageView();
+        if (serial)
+            image = image.with(sk28a::kUserIdAddress, serial->data(), serial->size());
+
+        std::unique_ptr<sk28a::Transport> transport;
+        const sk28a::FirmwareDevice* firmware_device = nullptr;
+        if (sim) {
+            transport = std::make_unique<sk28a::SimDevice>();
+        } else if (firmware_sim) {
+            auto dev = std::make_unique<sk28a::FirmwareDevice>();
+            firmware_device = dev.get();
+            transport = std::move(dev);
+        } else {
+            const auto found = find_bootloaders();
+            std::string device;
+            if (!devices.empty()) {
+                device = resolve_device(devices.front(), found).path;
+            } else if (!found.empty()) {
+                device = found.front().path;
+            } else {
+                std::fprintf(stderr, "sk28a-flash: no bootloader found (%04X:%04X)\n", sk28a::kVendorId,
+                             sk28a::kProductId);
+                return 1;
+            }
+            transport = open_bootloader(device);
+        }
+
+        sk28a::Flasher flasher(*transport, options);
+        if (!quiet) {
+            flasher.set_progress([&](std::string_view phase, uint64_t done, uint64_t total) {
+                if (phase != last_phase) {
+                    if (!last_phase.empty())
+                        std::fputc('\n', stderr);
+                    last_phase = std::string(phase);
+                }
+                std::fprintf(stderr, "\r%-8s %3u%%", last_phase.c_str(),
+                             total != 0 ? static_cast<unsigned>(done * 100 / total) : 100u);
+                const sk28a::ProgramStats& stats = flasher.program_stats();
+                if (phase == "program" && (stats.compressed_packets != 0 || stats.fill_packets != 0))
+                    std::fprintf(stderr, "  %.2f:1", stats.ratio());
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto virtual_start = firmware_device != nullptr ? firmware_device->virtual_time()
+                                                              : std::chrono::microseconds::zero();
+        uint64_t resumed = 0;
+        if (!journal_path.empty()) {
+            sk28a::Journal journal(journal_path);
+            resumed = flasher.flash(image, journal);
+        } else {
+            flasher.flash(image);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (!quiet) {
+            if (!last_phase.empty())
+                std::fputc('\n', stderr);
+            last_phase.clear();
+            std::fprintf(stderr, "%s: %zu bytes in %.2f s (%llu reports sent, %llu received)\n",
+                         transport->description().c_str(), flasher.writable_part(image).byte_count(), elapsed.count(),
+                         static_cast<unsigned long long>(transport->stats().reports_written),
+                         static_cast<unsigned long long>(transport->stats().reports_read));
+            const sk28a::ProgramStats& stats = flasher.program_stats();
+            if (stats.compressed_packets != 0 || stats.fill_packets != 0)
+                std::fprintf(stderr,
+                             "program: %llu bytes sent as %llu (%.2f:1), %llu of %llu packets compressed, %llu FILL\n",
+                             static_cast<unsigned long long>(stats.bytes), static_cast<unsigned long long>(stats.payload),
+                             stats.ratio(), static_cast<unsigned long long>(stats.compressed_packets),
+                             static_cast<unsigned long long>(stats.packets),
+                             static_cast<unsigned long long>(stats.fill_packets));
+            if (resumed != 0)
+                std::fprintf(stderr, "resumed from %s, %llu bytes were already there\n", journal_path.c_str(),
+                             static_cast<unsigned long long>(resumed));
+            if (serial)
+                std::fprintf(stderr, "serial number %s\n", sk28a::serial_number(*serial).c_str());
+            if (firmware_device != nullptr) {
+                const std::chrono::duration<double> predicted = firmware_device->virtual_time() - virtual_start;
+                const std::chrono::duration<double> writing = firmware_device->write_time();
+                std::fprintf(stderr, "on a board: %.2f s predicted, %.2f s of it flash/EEPROM writes, %llu NAKs\n",
+                             predicted.count(), writing.count(),
+                             static_cast<unsigned long long>(firmware_device->nak_count()));
+            }
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%ssk28a-flash: %s\n", last_phase.empty() ? "" : "\n", e.what());
+        return 1;
+    }
+    return 0;
+}
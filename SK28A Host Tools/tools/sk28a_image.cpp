@@ -0,0 +1,105 @@
+// sk28a-image: converts Intel HEX files to .sk28img (see image.h) and checks
+// .sk28img files
+#include <getopt.h>
+
+#include <cstdio>
+#include <string>
+
+#include "sk28a/image.h"
+#include "sk28a/protocol.h"
+
+namespace {
+
+void usage(FILE* out) {
+    std::fprintf(out,
+                 "Usage: sk28a-image IMAGE.hex OUTPUT.sk28img\n"
+                 "       sk28a-image --check IMAGE.sk28img...\n"
+                 "\n"
+                 "Converts a hex file to the .sk28img format sk28a-flash reads without parsing, or checks the\n"
+                 "CRCs of .sk28img files and lists their regions.\n"
+                 "\n"
+                 "Options:\n"
+                 "      --check         check and list instead of converting\n"
+                 "  -q, --quiet         don't list the regions\n"
+                 "  -h, --help\n");
+}
+
+void list(const sk28a::ImageFile& file) {
+    for (const auto& r : file.regions()) {
+        const auto first = file.row(r.first_row);
+        const auto last = file.row(r.first_row + r.row_count - 1);
+        std::printf("  %-8s 0x%06X-0x%06X  %5u rows  %6u bytes\n", sk28a::to_string(r.kind).c_str(), first.address,
+                    last.address + static_cast<uint32_t>(sk28a::kEraseRowSize) - 1, r.row_count, r.byte_count);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    enum { kOptCheck = 256 };
+    static const option long_options[] = {
+        {"check", no_argument, nullptr, kOptCheck},
+        {"quiet", no_argument, nullptr, 'q'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    bool check = false;
+    bool quiet = false;
+    int c;
+    while ((c = getopt_long(argc, argv, "qh", long_options, nullptr)) != -1) {
+        switch (c) {
+        case kOptCheck:
+            check = true;
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 2;
+        }
+    }
+
+    if (check) {
+        if (optind == argc) {
+            usage(stderr);
+            return 2;
+        }
+        int status = 0;
+        for (int i = optind; i < argc; ++i) {
+            try {
+                const sk28a::ImageFile file(argv[i]);
+                if (!quiet) {
+                    std::printf("%s: OK\n", argv[i]);
+                    list(file);
+                }
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "sk28a-image: %s\n", e.what());
+                status = 1;
+            }
+        }
+        return status;
+    }
+
+    if (optind + 2 != argc) {
+        usage(stderr);
+        return 2;
+    }
+    try {
+        sk28a::write_image_file(sk28a::read_hex_file(argv[optind]), argv[optind + 1]);
+        if (!quiet) {
+            // Read back, so what gets listed is what landed in the file
+            const sk28a::ImageFile file(argv[optind + 1]);
+            std::printf("%s:\n", argv[optind + 1]);
+            list(file);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "sk28a-image: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,341 @@
+// sk28a-uhid: puts the host build of the firmware on the system as a HID
+// device through /dev/uhid, so hidraw clients (sk28a-flash, HIDAPI based
+// tools) can talk to it as they would to a board in bootloader mode.
+//
+// The device gets the VID/PID, strings and report descriptor the firmware
+// itself reports.  Each OUT report from the kernel goes to the firmware's
+// endpoint, and IN reports go back as input reports.  By default the
+// firmware's virtual clock is held to the wall clock, so flash writes and
+// the 1 ms HID frames take as long as on a board.  The firmware keeps its
+// state in globals: run one process per virtual board.
+#include <fcntl.h>
+#include <getopt.h>
+#include <linux/uhid.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "sk28a/firmware_device.h"
+
+namespace {
+
+volatile sig_atomic_t stop_requested = 0;
+
+void on_signal(int) { stop_requested = 1; }
+
+void usage(FILE* out) {
+    std::fprintf(out,
+                 "Usage: sk28a-uhid [options]\n"
+                 "\n"
+                 "Runs the host build of the bootloader firmware as a HID device (needs write access to /dev/uhid),\n"
+                 "until interrupted.\n"
+                 "\n"
+                 "Options:\n"
+                 "      --uhid PATH     uhid character device (default /dev/uhid)\n"
+                 "      --phys NAME     physical path reported for the device (default sk28a-uhid/PID)\n"
+                 "      --fast          don't hold the firmware's clock to the wall clock\n"
+                 "  -q, --quiet         don't log device events\n"
+                 "  -h, --help\n");
+}
+
+std::system_error errno_error(const std::string& what) { return std::system_error(errno, std::generic_category(), what); }
+
+// UTF-16LE string descriptor to ASCII, '?' for everything else
+std::string string_descriptor(sk28a::FirmwareDevice& device, uint8_t index, uint16_t language) {
+    if (index == 0)
+        return {};
+    const std::vector<uint8_t> d = device.descriptor(3, index, language);
+    std::string s;
+    for (size_t i = 2; i + 1 < d.size() && i + 1 < d[0]; i += 2)
+        s += d[i + 1] == 0 && d[i] >= 0x20 && d[i] < 0x7F ? static_cast<char>(d[i]) : '?';
+    return s;
+}
+
+class Uhid {
+public:
+    explicit Uhid(const std::string& path) : path_(path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd_ < 0)
+            throw errno_error("cannot open " + path);
+    }
+    ~Uhid() { ::close(fd_); }
+    Uhid(const Uhid&) = delete;
+    Uhid& operator=(const Uhid&) = delete;
+
+    int fd() const { return fd_; }
+
+    void send(const uhid_event& ev) {
+        ssize_t n;
+        do {
+            n = ::write(fd_, &ev, sizeof ev);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0)
+            throw errno_error("write to " + path_);
+        if (static_cast<size_t>(n) != sizeof ev)
+            throw std::runtime_error("short write to " + path_);
+    }
+
+    // False if nothing arrived within the timeout
+    bool receive(uhid_event& ev, int timeout_ms) {
+        pollfd pfd{fd_, POLLIN, 0};
+        const int ready = ::poll(&pfd, 1, timeout_ms);
+        if (ready < 0 && errno != EINTR)
+            throw errno_error("poll on " + path_);
+        if (ready <= 0)
+            return false;
+        const ssize_t n = ::read(fd_, &ev, sizeof ev);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                return false;
+            throw errno_error("read from " + path_);
+        }
+        if (n == 0)
+            throw std::runtime_error(path_ + " closed");
+        return true;
+    }
+
+private:
+    std::string path_;
+    int fd_;
+};
+
+class VirtualBoard {
+public:
+    VirtualBoard(sk28a::FirmwareDevice& device, Uhid& uhid, std::string phys, bool quiet)
+        : device_(device), uhid_(uhid), phys_(std::move(phys)), quiet_(quiet) {}
+
+    // Plugs the board in: UHID_CREATE2 with what the firmware enumerated as
+    void create() {
+        const std::vector<uint8_t> dev = device_.descriptor(1);
+        const std::vector<uint8_t> languages = device_.descriptor(3, 0);
+        const std::vector<uint8_t> report = device_.descriptor(0x22);
+        if (dev.size() < 18 || report.empty() || report.size() > HID_MAX_DESCRIPTOR_SIZE)
+            throw std::runtime_error("firmware gave unusable descriptors");
+        const uint16_t language = languages.size() >= 4 ? languages[2] | languages[3] << 8 : 0x0409;
+        const std::string manufacturer = string_descriptor(device_, dev[14], language);
+        const std::string product = string_descriptor(device_, dev[15], language);
+        const std::string serial = string_descriptor(device_, dev[16], language);
+
+        uhid_event ev{};
+        ev.type = UHID_CREATE2;
+        auto& c = ev.u.create2;
+        // Named as usbhid names a USB device
+        std::snprintf(reinterpret_cast<char*>(c.name), sizeof c.name, "%s%s%s", manufacturer.c_str(),
+                      manufacturer.empty() || product.empty() ? "" : " ", product.c_str());
+        std::snprintf(reinterpret_cast<char*>(c.phys), sizeof c.phys, "%s", phys_.c_str());
+        std::snprintf(reinterpret_cast<char*>(c.uniq), sizeof c.uniq, "%s", serial.c_str());
+        c.rd_size = static_cast<uint16_t>(report.size());
+        c.bus = BUS_USB;
+        c.vendor = dev[8] | dev[9] << 8;
+        c.product = dev[10] | dev[11] << 8;
+        c.version = dev[12] | dev[13] << 8;
+        c.country = 0;
+        std::memcpy(c.rd_data, report.data(), report.size());
+        uhid_.send(ev);
+        created_ = true;
+        resets_ = device_.reset_count();
+        log("created %04X:%04X \"%s\"", c.vendor, c.product, reinterpret_cast<const char*>(c.name));
+    }
+
+    void destroy() {
+        if (!created_)
+            return;
+        uhid_event ev{};
+        ev.type = UHID_DESTROY;
+        uhid_.send(ev);
+        created_ = false;
+    }
+
+    void handle(const uhid_event& ev) {
+        switch (ev.type) {
+        case UHID_START:
+            log("started by the kernel");
+            break;
+        case UHID_STOP:
+            log("stopped by the kernel");
+            break;
+        case UHID_OPEN:
+            log("opened");
+            break;
+        case UHID_CLOSE:
+            log("closed");
+            break;
+        case UHID_OUTPUT:
+            output(ev.u.output.data, ev.u.output.size);
+            break;
+        case UHID_GET_REPORT: {
+            // HIDGetReportHandler()/HIDSetReportHandler() are empty, so the firmware stalls these on EP0
+            uhid_event reply{};
+            reply.type = UHID_GET_REPORT_REPLY;
+            reply.u.get_report_reply.id = ev.u.get_report.id;
+            reply.u.get_report_reply.err = EIO;
+            uhid_.send(reply);
+            break;
+        }
+        case UHID_SET_REPORT: {
+            uhid_event reply{};
+            reply.type = UHID_SET_REPORT_REPLY;
+            reply.u.set_report_reply.id = ev.u.set_report.id;
+            reply.u.set_report_reply.err = EIO;
+            uhid_.send(reply);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // Forwards an IN report if the firmware sent one, running it for up to the given virtual time
+    bool poll_input(std::chrono::milliseconds timeout) {
+        sk28a::Packet packet;
+        if (!device_.read(packet, timeout)) {
+            check_reset();
+            return false;
+        }
+        uhid_event ev{};
+        ev.type = UHID_INPUT2;
+        ev.u.input2.size = sk28a::kPacketSize;
+        std::memcpy(ev.u.input2.data, packet.bytes.data(), sk28a::kPacketSize);
+        if (created_)
+            uhid_.send(ev);
+        check_reset();
+        return true;
+    }
+
+private:
+    void output(const uint8_t* data, size_t size) {
+        // hid_rpt01 has no report IDs: hidraw passes the report number 0 down in front of the report
+        if (size == sk28a::kPacketSize + 1 && data[0] == 0) {
+            ++data;
+            --size;
+        }
+        sk28a::Packet packet;
+        std::memcpy(packet.bytes.data(), data, std::min(size, sk28a::kPacketSize));
+        device_.write(packet);
+        check_reset();
+    }
+
+    // After RESET_DEVICE the board drops off the bus and comes back up, as a new hidraw node
+    void check_reset() {
+        if (device_.reset_count() == resets_)
+            return;
+        log("reset");
+        destroy();
+        create();
+    }
+
+    __attribute__((format(printf, 2, 3))) void log(const char* format, ...) {
+        if (quiet_)
+            return;
+        va_list args;
+        va_start(args, format);
+        std::fprintf(stderr, "sk28a-uhid: ");
+        std::vfprintf(stderr, format, args);
+        std::fputc('\n', stderr);
+        va_end(args);
+    }
+
+    sk28a::FirmwareDevice& device_;
+    Uhid& uhid_;
+    std::string phys_;
+    bool quiet_;
+    bool created_ = false;
+    unsigned long resets_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    enum { kOptUhid = 256, kOptPhys, kOptFast };
+    static const option long_options[] = {
+        {"uhid", required_argument, nullptr, kOptUhid},
+        {"phys", required_argument, nullptr, kOptPhys},
+        {"fast", no_argument, nullptr, kOptFast},
+        {"quiet", no_argument, nullptr, 'q'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    std::string uhid_path = "/dev/uhid";
+    std::string phys = "sk28a-uhid/" + std::to_string(::getpid());
+    bool fast = false;
+    bool quiet = false;
+    int c;
+    while ((c = getopt_long(argc, argv, "qh", long_options, nullptr)) != -1) {
+        switch (c) {
+        case kOptUhid:
+            uhid_path = optarg;
+            break;
+        case kOptPhys:
+            phys = optarg;
+            break;
+        case kOptFast:
+            fast = true;
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 2;
+        }
+    }
+    if (optind != argc) {
+        usage(stderr);
+        return 2;
+    }
+
+    struct sigaction sa {};
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    try {
+        Uhid uhid(uhid_path);
+        sk28a::FirmwareDevice device;
+        VirtualBoard board(device, uhid, phys, quiet);
+        board.create();
+
+        const auto start = std::chrono::steady_clock::now();
+        uhid_event ev;
+        while (!stop_requested) {
+            // Let the firmware run until its clock catches up with the wall clock (a while, with --fast), then
+            // wait for the kernel.  A firmware that is ahead, after a flash write say, waits until the wall clock
+            // catches up.  An input report means there may be more to come, so the kernel isn't waited for.
+            int wait_ms;
+            if (fast) {
+                wait_ms = board.poll_input(std::chrono::milliseconds(10)) ? 0 : 1;
+            } else {
+                const auto behind = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start - device.virtual_time());
+                if (behind.count() > 0 && board.poll_input(behind))
+                    wait_ms = 0;
+                else
+                    wait_ms = static_cast<int>(std::max<int64_t>(1, 1 - behind.count()));
+            }
+            while (uhid.receive(ev, wait_ms)) {
+                board.handle(ev);
+                wait_ms = 0;
+            }
+        }
+        board.destroy();
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "sk28a-uhid: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}